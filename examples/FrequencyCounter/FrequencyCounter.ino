@@ -0,0 +1,95 @@
+/****************************************************************************************************************************
+  FrequencyCounter.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Measures the frequency on pin 7, which must be an external interrupt pin, without one interrupt per edge.
+   Each rising edge is routed from the EIC through EVSYS (channel 2) to the 32-bit TC4/TC5 counter in hardware,
+   and TC3 interrupts once per 1s gate to read the counter. Connect a signal source up to a few MHz to pin 7.
+   TC4 and TC5 can't be used for anything else while the counter runs.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+#include "SAMD_TimerFreqCounter.h"
+
+
+#define FREQ_PIN                  7
+#define GATE_TIME_US              1000000
+
+// Init SAMD timer TIMER_TC3 as the gate timer
+SAMDTimer ITimer(TIMER_TC3);
+
+// EVSYS channel 2
+SAMDTimerFreqCounter freqCounter(2);
+
+volatile bool newReading = false;
+
+// Called in the gate timer interrupt, once per gate
+void gateDone(const float& frequency)
+{
+  (void) frequency;
+
+  newReading = true;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting FrequencyCounter on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+
+  if (freqCounter.begin(ITimer, FREQ_PIN, GATE_TIME_US, gateDone))
+  {
+    Serial.print(F("Starting freqCounter OK, gate time (us) = ")); Serial.println(GATE_TIME_US);
+  }
+  else
+    Serial.println(F("Can't start freqCounter. Select another pin"));
+}
+
+void loop()
+{
+  if (newReading)
+  {
+    newReading = false;
+
+    Serial.print(F("Frequency (Hz) = ")); Serial.print(freqCounter.getFrequency());
+    Serial.print(F(", edges = ")); Serial.print(freqCounter.getCount());
+    Serial.print(F(", gates = ")); Serial.println(freqCounter.getGateCount());
+  }
+}
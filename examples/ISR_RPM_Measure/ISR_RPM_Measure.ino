@@ -22,16 +22,16 @@
    if the interrupt changes a multi-byte variable between a sequence of instructions, it can be read incorrectly.
    If your data is multiple variables, such as an array and a count, usually interrupts need to be disabled
    or the entire sequence of your code which accesses the data.
+   Here the capture callback publishes each measurement through a SAMDDoubleBuffer instead, and loop() reads a
+   consistent copy of all its fields without disabling interrupts.
 
-   RPM Measuring uses high frequency hardware timer 1Hz == 1ms) to measure the time from of one rotation, in ms
-   then convert to RPM. One rotation is detected by reading the state of a magnetic REED SW or IR LED Sensor
+   RPM Measuring uses hardware input capture. Each edge of the magnetic REED SW or IR LED Sensor goes from the EIC
+   through the Event System to TCC1, which captures the time between edges at 48MHz / prescaler resolution.
+   The CPU is only interrupted once per rotation, and no timer has to tick every 1ms.
    Asssuming LOW is active.
    For example: Max speed is 600RPM => 10 RPS => minimum 100ms a rotation. We'll use 80ms for debouncing
-   If the time between active state is less than 8ms => consider noise.
-   RPM = 60000 / (rotation time in ms)
-
-   We use interrupt to detect whenever the SW is active, set a flag
-   then use timer to count the time between active state
+   Periods shorter than that are contact bounces, and are added to the rotation being measured.
+   RPM = 60 * tick frequency / (rotation time in ticks)
 */
 
 #if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
@@ -54,6 +54,8 @@
 
 // To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
 #include "SAMDTimerInterrupt.h"
+#include "SAMD_TimerCapture.h"
+#include "SAMD_TimerSeqLock.h"
 
 //#ifndef LED_BUILTIN
 //  #define LED_BUILTIN       13
@@ -69,82 +71,68 @@
 
 unsigned int interruptPin = 7;
 
-#define TIMER1_INTERVAL_MS          1
 #define DEBOUNCING_INTERVAL_MS      80
 
+// Longest rotation time measured. Slower than that => RPM = 0
+#define MAX_ROTATION_TIME_MS        5000
+
 #define LOCAL_DEBUG                 1
 
-// Depending on the board, you can select SAMD21 Hardware Timer from TC3-TCC
-// SAMD21 Hardware Timer from TC3 or TCC
-// SAMD51 Hardware Timer only TC3
+// TCC1 capture, EVSYS channel 1
+SAMDTimerCapture RPMCapture(1);
 
-// Init SAMD timer TIMER_TC3
-SAMDTimer ITimer1(TIMER_TC3);
+typedef struct
+{
+  uint32_t rotationTicks;     // 0 => stopped
+  uint32_t rotations;
+  uint32_t lastRotationMs;
+} RPMSample;
 
-#if (TIMER_INTERRUPT_USING_SAMD21)
-// Init SAMD timer TIMER_TCC
-//SAMDTimer ITimer1(TIMER_TCC);
-#endif
+// Written by detectRotation() only
+SAMDDoubleBuffer<RPMSample> RPMSamples;
 
-volatile unsigned long rotationTime = 0;
-float RPM       = 0.00;
-float avgRPM    = 0.00;
-
-volatile int debounceCounter;
+uint32_t bounceTicks     = 0;
+uint32_t rotations       = 0;
+uint32_t lastRotationMs  = 0;
 
-volatile bool activeState = false;
+uint32_t debounceTicks;
 
-void detectRotation()
-{
-  activeState = true;
-}
+float RPM       = 0.00;
+float avgRPM    = 0.00;
 
-void TimerHandler1()
+void detectRotation(const uint32_t& period, const uint32_t& pulseWidth)
 {
-  if ( activeState )
-  {
-    // Reset to prepare for next round of interrupt
-    activeState = false;
-
-    if (debounceCounter >= DEBOUNCING_INTERVAL_MS / TIMER1_INTERVAL_MS )
-    {
+  (void) pulseWidth;
 
-      //min time between pulses has passed
-      RPM = (float) ( 60000.0f / ( rotationTime * TIMER1_INTERVAL_MS ) );
+  RPMSample& sample = RPMSamples.back();
 
-      avgRPM = ( 2 * avgRPM + RPM) / 3,
-
-#if (TIMER_INTERRUPT_DEBUG > 1)
-      Serial.print("RPM = "); Serial.print(avgRPM);
-      Serial.print(", rotationTime ms = "); Serial.println(rotationTime * TIMER1_INTERVAL_MS);
-#endif
+  if (period == 0)
+  {
+    // No edge for longer than MAX_ROTATION_TIME_MS
+    bounceTicks = 0;
 
-      rotationTime = 0;
-      debounceCounter = 0;
-    }
-    else
-      debounceCounter++;
+    sample.rotationTicks  = 0;
   }
   else
   {
-    debounceCounter++;
-  }
+    bounceTicks += period;
 
-  if (rotationTime >= 5000)
-  {
-    // If idle, set RPM to 0, don't increase rotationTime
-    RPM = 0;
-    
-#if (TIMER_INTERRUPT_DEBUG > 1)   
-    Serial.print("RPM = "); Serial.print(RPM); Serial.print(", rotationTime = "); Serial.println(rotationTime);
-#endif
+    // min time between pulses not passed yet
+    if (bounceTicks < debounceTicks)
+      return;
 
-    rotationTime = 0;
-  }
-  else
-  {
-    rotationTime++;
+    sample.rotationTicks  = bounceTicks;
+    bounceTicks           = 0;
+    
+    rotations++;
+    lastRotationMs        = millis();
   }
+
+  // back() holds an older sample, so write all the fields
+  sample.rotations      = rotations;
+  sample.lastRotationMs = lastRotationMs;
+
+  RPMSamples.publish();
 }
 
 void setup()
@@ -160,19 +148,39 @@ void setup()
   Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
   Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
   
-  // Interval in microsecs, must multiply to 1000 here or crash
-  if (ITimer1.attachInterruptInterval(TIMER1_INTERVAL_MS * 1000, TimerHandler1))
+  // Max period in microsecs
+  if (RPMCapture.begin(interruptPin, detectRotation, MAX_ROTATION_TIME_MS * 1000.0f))
   {
-    Serial.print(F("Starting ITimer1 OK, millis() = ")); Serial.println(millis());
+    Serial.print(F("Starting RPMCapture OK, tick frequency = ")); Serial.println(RPMCapture.getTickFrequency());
   }
   else
-    Serial.println(F("Can't set ITimer1. Select another freq. or timer"));
+    Serial.println(F("Can't start RPMCapture. Select an external interrupt pin"));
 
-  // Assumming the interruptPin will go LOW
-  attachInterrupt(digitalPinToInterrupt(interruptPin), detectRotation, FALLING);
+  debounceTicks = (uint32_t) ( (uint64_t) RPMCapture.getTickFrequency() * DEBOUNCING_INTERVAL_MS / 1000 );
 }
 
 void loop()
 {
+  static uint32_t lastPrint = 0;
 
+  // Consistent with each other, even if a rotation is captured meanwhile
+  RPMSample sample = RPMSamples.read();
+
+  uint32_t ticks = sample.rotationTicks;
+
+  RPM = (ticks == 0) ? 0 : ( 60.0f * RPMCapture.getTickFrequency() / ticks );
+
+  if (millis() - lastPrint >= 1000)
+  {
+    lastPrint = millis();
+
+    avgRPM = ( 2 * avgRPM + RPM) / 3;
+
+#if (LOCAL_DEBUG > 0)
+    Serial.print(F("RPM = ")); Serial.print(avgRPM);
+    Serial.print(F(", rotationTime ms = ")); Serial.print(ticks * 1000.0f / RPMCapture.getTickFrequency());
+    Serial.print(F(", rotations = ")); Serial.print(sample.rotations);
+    Serial.print(F(", last at millis() = ")); Serial.println(sample.lastRotationMs);
+#endif
+  }
 }
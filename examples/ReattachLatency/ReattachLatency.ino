@@ -0,0 +1,141 @@
+/****************************************************************************************************************************
+  ReattachLatency.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Measures how many CPU cycles attachInterruptInterval() takes in each case:
+   - the first attach, which configures the GCLK, the counter mode and the NVIC
+   - a reattach with the same period and a new callback, which only swaps the callback
+   - a reattach after detachInterrupt(), which also re-enables the IRQ
+   - a new period with the same prescaler, which only writes CC / PER
+   - a new period needing another prescaler, which also rewrites CTRLA
+   Cycles are read from SysTick, which counts down at F_CPU and reloads every ms.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+
+
+#define NUMBER_OF_RUNS          16
+
+volatile uint32_t countA = 0;
+volatile uint32_t countB = 0;
+
+// Init SAMD timer TIMER_TC3
+SAMDTimer ITimer(TIMER_TC3);
+
+void TimerHandlerA()
+{
+  countA++;
+}
+
+void TimerHandlerB()
+{
+  countB++;
+}
+
+// SysTick->VAL counts down from SysTick->LOAD, good for anything shorter than 1ms
+uint32_t cyclesSince(const uint32_t& start)
+{
+  uint32_t now = SysTick->VAL;
+  
+  return (start >= now) ? (start - now) : (start + SysTick->LOAD + 1 - now);
+}
+
+// Fastest of NUMBER_OF_RUNS, as the SysTick and USB interrupts may land inside some runs
+void printLatency(const __FlashStringHelper* name, const float& fromPeriod, const float& toPeriod, const bool& detachFirst)
+{
+  uint32_t minCycles = 0xFFFFFFFF;
+  
+  for (uint8_t i = 0; i < NUMBER_OF_RUNS; i++)
+  {
+    ITimer.attachInterruptInterval(fromPeriod, TimerHandlerA);
+    
+    if (detachFirst)
+      ITimer.detachInterrupt();
+    
+    uint32_t start  = SysTick->VAL;
+    
+    ITimer.attachInterruptInterval(toPeriod, (i & 1) ? TimerHandlerA : TimerHandlerB);
+    
+    uint32_t cycles = cyclesSince(start);
+    
+    if (cycles < minCycles)
+      minCycles = cycles;
+  }
+  
+  Serial.print(name); Serial.print(F(" = ")); Serial.print(minCycles);
+  Serial.print(F(" cycles, ")); Serial.print(minCycles * 1000000.0f / F_CPU, 2); Serial.println(F(" us"));
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting ReattachLatency on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+  
+  uint32_t start  = SysTick->VAL;
+  
+  ITimer.attachInterruptInterval(500, TimerHandlerA);
+  
+  uint32_t cycles = cyclesSince(start);
+  
+  Serial.print(F("First attach")); Serial.print(F(" = ")); Serial.print(cycles);
+  Serial.print(F(" cycles, ")); Serial.print(cycles * 1000000.0f / F_CPU, 2); Serial.println(F(" us"));
+
+  // 500us and 700us share the same prescaler, 30000us needs another one
+  printLatency(F("Same period, new callback"),      500, 500,   false);
+  printLatency(F("After detachInterrupt()"),        500, 500,   true);
+  printLatency(F("New period, same prescaler"),     500, 700,   false);
+  printLatency(F("New period, another prescaler"),  500, 30000, false);
+}
+
+void loop()
+{
+  static uint32_t lastCountA = 0;
+  static uint32_t lastCountB = 0;
+  
+  delay(1000);
+
+  // One of the handlers should run every 30ms
+  Serial.print(F("countA = ")); Serial.print(countA - lastCountA);
+  Serial.print(F(", countB = ")); Serial.println(countB - lastCountB);
+  
+  lastCountA = countA;
+  lastCountB = countB;
+}
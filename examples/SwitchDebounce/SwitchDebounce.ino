@@ -22,6 +22,8 @@
    if the interrupt changes a multi-byte variable between a sequence of instructions, it can be read incorrectly.
    If your data is multiple variables, such as an array and a count, usually interrupts need to be disabled
    or the entire sequence of your code which accesses the data.
+   Here TimerHandler() publishes the switch state and its timestamps through a SAMDSeqLock instead, and loop() reads
+   a consistent copy without disabling interrupts.
 
    Switch Debouncing uses high frequency hardware timer 50Hz == 20ms) to measure the time from the SW is pressed,
    debouncing time is 100ms => SW is considered pressed if timer count is > 5, then call / flag SW is pressed
@@ -49,6 +51,7 @@
 #define _TIMERINTERRUPT_LOGLEVEL_     0
 
 #include "SAMDTimerInterrupt.h"
+#include "SAMD_TimerSeqLock.h"
 
 //#ifndef LED_BUILTIN
 //  #define LED_BUILTIN       13
@@ -85,6 +88,20 @@ SAMDTimer ITimer(TIMER_TC3);
 volatile bool SWPressed     = false;
 volatile bool SWLongPressed = false;
 
+typedef struct
+{
+  bool      pressed;
+  bool      longPressed;
+  uint32_t  pressCount;
+  uint32_t  pressedTime;      // millis(), debouncing time excluded
+  uint32_t  releasedTime;
+} SWState;
+
+// ISR working copy, published to loop() on each change
+SWState SWStateISR;
+
+SAMDSeqLock<SWState> SWStateShared;
+
 void TimerHandler()
 {
   static unsigned int debounceCountSWPressed  = 0;
@@ -122,6 +139,12 @@ void TimerHandler()
 #endif
 
         SWPressed = true;
+
+        SWStateISR.pressed      = true;
+        SWStateISR.pressCount++;
+        SWStateISR.pressedTime  = millis() - DEBOUNCING_INTERVAL_MS;
+        SWStateShared.write(SWStateISR);
+
         // Do something for SWPressed here in ISR
         // But it's better to use outside software timer to do your job instead of inside ISR
         //Your_Response_To_Press();
@@ -139,6 +162,10 @@ void TimerHandler()
 #endif          
 
           SWLongPressed = true;
+
+          SWStateISR.longPressed  = true;
+          SWStateShared.write(SWStateISR);
+
           // Do something for SWLongPressed here in ISR
           // But it's better to use outside software timer to do your job instead of inside ISR
           //Your_Response_To_Long_Press();
@@ -161,6 +188,11 @@ void TimerHandler()
       SWPressed     = false;
       SWLongPressed = false;
 
+      SWStateISR.pressed      = false;
+      SWStateISR.longPressed  = false;
+      SWStateISR.releasedTime = millis() - DEBOUNCING_INTERVAL_MS;
+      SWStateShared.write(SWStateISR);
+
       // Do something for !SWPressed here in ISR
       // But it's better to use outside software timer to do your job instead of inside ISR
       //Your_Response_To_Release();
@@ -197,5 +229,27 @@ void setup()
 
 void loop()
 {
+  static uint32_t lastSequence = 0;
 
+  if (SWStateShared.getSequence() == lastSequence)
+    return;
+
+  lastSequence = SWStateShared.getSequence();
+
+  // All fields from the same write(), even if the switch changes meanwhile
+  SWState state = SWStateShared.read();
+
+#if (LOCAL_DEBUG > 0)
+  if (state.pressed)
+  {
+    Serial.print(state.longPressed ? F("SW Long Pressed") : F("SW Pressed"));
+    Serial.print(F(", count = ")); Serial.print(state.pressCount);
+    Serial.print(F(", at millis() = ")); Serial.println(state.pressedTime);
+  }
+  else
+  {
+    Serial.print(F("SW Released, at millis() = ")); Serial.print(state.releasedTime);
+    Serial.print(F(", pressed ms = ")); Serial.println(state.releasedTime - state.pressedTime);
+  }
+#endif
 }
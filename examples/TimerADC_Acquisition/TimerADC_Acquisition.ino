@@ -0,0 +1,126 @@
+/****************************************************************************************************************************
+  TimerADC_Acquisition.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Samples A1 at exactly 20kHz. The TC3 overflow starts each ADC conversion through the Event System, and DMA moves
+   each result into one of two ping-pong buffers. The block callback runs once per 256 samples, only to hand over the
+   full buffer; the statistics are computed in loop() while the other buffer fills.
+   Other DMA users, such as Adafruit_ZeroDMA or I2S, can't be used at the same time.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+#include "SAMD_TimerADC.h"
+
+#define ADC_PIN                   A1
+#define SAMPLE_RATE_HZ            20000
+#define SAMPLES_PER_BLOCK         256
+
+uint16_t bufferA[SAMPLES_PER_BLOCK];
+uint16_t bufferB[SAMPLES_PER_BLOCK];
+
+const uint16_t* volatile readyBlock = NULL;
+
+// Init SAMD timer TIMER_TC3, used only to pace the ADC
+SAMDTimer ITimer(TIMER_TC3);
+
+// DMAC channel 0, EVSYS channel 0
+SAMDTimerADC adc(0, 0);
+
+// Runs in the DMAC interrupt, keep it short
+void blockDone(const uint16_t* samples, const uint16_t& count)
+{
+  (void) count;
+  
+  readyBlock = samples;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerADC_Acquisition on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+
+  if (adc.begin(ITimer, ADC_PIN, SAMPLE_RATE_HZ, bufferA, bufferB, SAMPLES_PER_BLOCK, blockDone))
+  {
+    Serial.print(F("Starting ADC OK, sample rate = ")); Serial.println(SAMPLE_RATE_HZ);
+  }
+  else
+    Serial.println(F("Can't start ADC. Select another sample rate or timer"));
+}
+
+void loop()
+{
+  static uint32_t lastPrint = 0;
+
+  const uint16_t* samples = readyBlock;
+
+  if (samples == NULL)
+    return;
+
+  readyBlock = NULL;
+
+  uint16_t  minValue  = 0xFFFF;
+  uint16_t  maxValue  = 0;
+  uint32_t  sum       = 0;
+
+  for (uint16_t i = 0; i < SAMPLES_PER_BLOCK; i++)
+  {
+    uint16_t value = samples[i];
+
+    sum += value;
+
+    if (value < minValue)
+      minValue = value;
+
+    if (value > maxValue)
+      maxValue = value;
+  }
+
+  if (millis() - lastPrint >= 1000)
+  {
+    lastPrint = millis();
+
+    // getBlockCount() should grow by SAMPLE_RATE_HZ / SAMPLES_PER_BLOCK every second
+    Serial.print(F("Blocks = "));   Serial.print(adc.getBlockCount());
+    Serial.print(F(", min = "));    Serial.print(minValue);
+    Serial.print(F(", max = "));    Serial.print(maxValue);
+    Serial.print(F(", mean = "));   Serial.println(sum / SAMPLES_PER_BLOCK);
+  }
+}
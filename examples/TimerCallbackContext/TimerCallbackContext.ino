@@ -0,0 +1,149 @@
+/****************************************************************************************************************************
+  TimerCallbackContext.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   One driver class, Blinker, serves several hardware timers without a static trampoline per instance. Each instance
+   attaches the same static function with itself as the context pointer, and the library passes the pointer back on
+   each call. Two Blinkers run on SAMD21, on TC3 and TCC. SAMD51 only has TC3, shared by the instances one after the
+   other.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+
+
+#if !defined(LED_BUILTIN)
+  #define LED_BUILTIN       13
+#endif
+
+class Blinker
+{
+  private:
+    SAMDTimer&        _timer;
+    uint8_t           _pin;
+    volatile uint32_t _toggles;
+    
+    // Shared by all the instances, 'self' tells which one
+    static void onTimer(void* self)
+    {
+      ((Blinker*) self)->toggle();
+    }
+    
+    void toggle()
+    {
+      digitalWrite(_pin, !digitalRead(_pin));
+      _toggles++;
+    }
+
+  public:
+  
+    Blinker(SAMDTimer& timer, const uint8_t& pin) : _timer(timer), _pin(pin), _toggles(0)
+    {
+    }
+    
+    bool begin(const unsigned long& interval)
+    {
+      pinMode(_pin, OUTPUT);
+      
+      return _timer.attachInterruptInterval(interval, onTimer, this);
+    }
+    
+    uint32_t getToggles()
+    {
+      return _toggles;
+    }
+};
+
+// Init SAMD timer TIMER_TC3
+SAMDTimer ITimer0(TIMER_TC3);
+
+#if (TIMER_INTERRUPT_USING_SAMD21)
+  // Init SAMD timer TIMER_TCC
+  SAMDTimer ITimer1(TIMER_TCC);
+  
+  Blinker blinker0(ITimer0, LED_BUILTIN);
+  Blinker blinker1(ITimer1, A1);
+#else
+  Blinker blinker0(ITimer0, LED_BUILTIN);
+  Blinker blinker1(ITimer0, A1);
+#endif
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerCallbackContext on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+
+  if (blinker0.begin(500000))
+  {
+    Serial.print(F("Starting blinker0 OK, micros() = ")); Serial.println(micros());
+  }
+  else
+    Serial.println(F("Can't set blinker0. Select another freq. or timer"));
+
+#if (TIMER_INTERRUPT_USING_SAMD21)
+  if (blinker1.begin(100000))
+  {
+    Serial.print(F("Starting blinker1 OK, micros() = ")); Serial.println(micros());
+  }
+  else
+    Serial.println(F("Can't set blinker1. Select another freq. or timer"));
+#endif
+}
+
+void loop()
+{
+  delay(5000);
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  // TC3 goes to the other instance every 5s
+  static bool useBlinker1 = false;
+  
+  useBlinker1 = !useBlinker1;
+  
+  if (useBlinker1)
+    blinker1.begin(100000);
+  else
+    blinker0.begin(500000);
+#endif
+
+  // 10 / s for blinker0, 50 / s for blinker1 while running
+  Serial.print(F("blinker0 toggles = ")); Serial.print(blinker0.getToggles());
+  Serial.print(F(", blinker1 toggles = ")); Serial.println(blinker1.getToggles());
+}
@@ -0,0 +1,103 @@
+/****************************************************************************************************************************
+  TimerClockCalibration.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Calibrates the 48MHz timer clock (DFLL48M) against the 32.768kHz crystal at startup.
+   TC3 runs from the crystal to produce the reference periods and TCC1 measures them, so both must be free meanwhile.
+   The error found is applied to every later attach: the 1000ms timer below is corrected without any reference input.
+   Needs a board with the XOSC32K crystal fitted, e.g. Arduino Zero, MKR boards, Adafruit Feather / Metro M4.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+#include "SAMD_TimerCalibration.h"
+
+
+#define TIMER_INTERVAL_MS     1000L
+
+// Longer windows average out more of the DFLL jitter
+#define CALIBRATION_MS        1000
+
+SAMDTimer         ITimer(TIMER_TC3);
+SAMDTimerCapture  Capture;
+
+volatile uint32_t timerCount = 0;
+
+void TimerHandler()
+{
+  timerCount++;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerClockCalibration on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+
+  if (SAMD_calibrateClock(ITimer, Capture, CALIBRATION_MS))
+  {
+    Serial.print(F("Timer clock error = ")); Serial.print(SAMD_getCalibrationError(), 3);
+    Serial.print(F(" ppm, applied correction = ")); Serial.print(SAMD_getClockError()); Serial.println(F(" ppb"));
+    Serial.print(F("Uncorrected drift would be ")); Serial.print(SAMD_getCalibrationError() * 86.4f, 1);
+    Serial.println(F(" ms/day"));
+  }
+  else
+    Serial.println(F("Can't calibrate, no 32.768kHz crystal ?"));
+
+  // Re-attach after the calibration, now corrected
+  if (ITimer.attachInterruptInterval(TIMER_INTERVAL_MS * 1000, TimerHandler))
+  {
+    Serial.print(F("Starting ITimer OK, millis() = ")); Serial.println(millis());
+  }
+  else
+    Serial.println(F("Can't set ITimer. Select another freq. or timer"));
+}
+
+void loop()
+{
+  static uint32_t lastCount = 0;
+
+  // millis() comes from the same DFLL48M, so it can't show the correction. Compare against a reference instead
+  if (timerCount != lastCount)
+  {
+    lastCount = timerCount;
+
+    Serial.print(F("Tick ")); Serial.println(lastCount);
+  }
+}
@@ -0,0 +1,129 @@
+/****************************************************************************************************************************
+  TimerDMA_Waveform.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Outputs a 1kHz sine wave on the DAC pin A0 without any CPU work per sample. TC3 runs as a trigger source only, and
+   each overflow makes DMAC channel 0 copy the next sample of sineTable into the DAC DATA register.
+   The CPU is only interrupted twice per table, by the half-complete and complete callbacks.
+   Other DMA users, such as Adafruit_ZeroDMA or I2S, can't be used at the same time.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+#include "SAMD_TimerDMA.h"
+
+#define NUMBER_OF_SAMPLES         64
+#define WAVE_FREQ_HZ              1000
+
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  #define DAC_BITS                12
+  #define DAC_DATA_REGISTER       (&DAC->DATA[0].reg)
+#else
+  #define DAC_BITS                10
+  #define DAC_DATA_REGISTER       (&DAC->DATA.reg)
+#endif
+
+uint16_t sineTable[NUMBER_OF_SAMPLES];
+
+volatile uint32_t halfCount = 0;
+volatile uint32_t fullCount = 0;
+
+// Init SAMD timer TIMER_TC3
+SAMDTimer ITimer(TIMER_TC3);
+
+// DMAC channel 0
+SAMDTimerDMA waveDMA(0);
+
+// First half of sineTable has been sent, it could be refilled now
+void halfDone()
+{
+  halfCount++;
+}
+
+// Second half of sineTable has been sent
+void fullDone()
+{
+  fullCount++;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerDMA_Waveform on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+
+  // Let the core enable the DAC and its pin
+  analogWriteResolution(DAC_BITS);
+  analogWrite(A0, 0);
+
+  for (uint16_t i = 0; i < NUMBER_OF_SAMPLES; i++)
+  {
+    sineTable[i] = (uint16_t) ( ( (1 << DAC_BITS) - 1 ) * ( 0.5 + 0.5 * sin(2 * PI * i / NUMBER_OF_SAMPLES) ) );
+  }
+
+  if (ITimer.setTriggerFrequency(NUMBER_OF_SAMPLES * WAVE_FREQ_HZ))
+  {
+    Serial.print(F("Starting ITimer OK, sample rate = ")); Serial.println(NUMBER_OF_SAMPLES * WAVE_FREQ_HZ);
+  }
+  else
+    Serial.println(F("Can't set ITimer. Select another freq. or timer"));
+
+  if (waveDMA.startOutput(ITimer.getDMATriggerSource(), sineTable, NUMBER_OF_SAMPLES, SAMD_DMA_BEAT_HWORD,
+                          DAC_DATA_REGISTER, halfDone, fullDone))
+  {
+    Serial.println(F("Starting waveDMA OK"));
+  }
+  else
+    Serial.println(F("Can't start waveDMA"));
+}
+
+void loop()
+{
+  static uint32_t lastFullCount = 0;
+
+  delay(1000);
+
+  uint32_t count = fullCount;
+
+  // Should be WAVE_FREQ_HZ
+  Serial.print(F("Waves / s = ")); Serial.print(count - lastFullCount);
+  Serial.print(F(", halfCount = ")); Serial.println(halfCount);
+
+  lastFullCount = count;
+}
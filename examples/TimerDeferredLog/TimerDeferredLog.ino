@@ -0,0 +1,109 @@
+/****************************************************************************************************************************
+  TimerDeferredLog.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Logs from the timer ISR with TIMERINTERRUPT_DEFERRED_LOG. Each TISR_LOG* call only stores a small binary record
+   (F() string addresses and raw values) in a RAM ring, taking a few us without Serial nor heap, and loop() prints
+   them with SAMD_flushLog(). The library debug logs of attachInterruptInterval() go through the same ring.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+// Deferred logging doesn't block, so the debug level is safe even in the ISR
+#define _TIMERINTERRUPT_LOGLEVEL_     4
+
+#define TIMERINTERRUPT_DEFERRED_LOG   true
+#define SAMD_LOG_BUFFER_SIZE          64
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+
+
+#define TIMER_INTERVAL_US     20000L
+
+// Every 20ms, far too often for synchronous Serial prints from the ISR
+SAMDTimer ITimer(TIMER_TC3);
+
+volatile uint32_t timerCount = 0;
+
+void TimerHandler()
+{
+  timerCount++;
+  
+  uint32_t start = micros();
+
+  TISR_LOGINFO3(F("TimerHandler: count ="), timerCount, F(", millis ="), millis());
+  
+  // Logged in the next call, so it doesn't time itself
+  static uint32_t lastCost = 0;
+  
+  if ((timerCount % 50) == 0)
+  {
+    TISR_LOGDEBUG3(F("TimerHandler: last log cost ="), lastCost, F("us, TC3 at 0x"), TISR_HEX(TC3));
+  }
+  
+  lastCost = micros() - start;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerDeferredLog on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+
+  // The library debug logs of the attach are stored too, and printed by the first flush
+  if (ITimer.attachInterruptInterval(TIMER_INTERVAL_US, TimerHandler))
+  {
+    Serial.print(F("Starting ITimer OK, millis() = ")); Serial.println(millis());
+  }
+  else
+    Serial.println(F("Can't set ITimer. Select another freq. or timer"));
+}
+
+void loop()
+{
+  static uint32_t lastDropped = 0;
+
+  // A slow loop() only costs records once the ring is full, never ISR time
+  delay(500);
+
+  SAMD_flushLog();
+
+  if (SAMD_getLogDropped() != lastDropped)
+  {
+    lastDropped = SAMD_getLogDropped();
+
+    Serial.print(F("Records dropped so far = ")); Serial.println(lastDropped);
+  }
+}
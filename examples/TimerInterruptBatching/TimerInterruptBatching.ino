@@ -0,0 +1,107 @@
+/****************************************************************************************************************************
+  TimerInterruptBatching.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Runs TC3 at 200kHz without interrupting the CPU on every period. Each TC3 overflow is counted by TCC2 through
+   EVSYS, and the CPU is only interrupted once per batch of BATCH_SIZE periods, with the number of periods elapsed.
+   With attachInterrupt() at 200kHz, the entry and exit of TC3_Handler alone would take most of the SAMD21 CPU time.
+   TCC2 can't be used for analogWrite() at the same time.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+#include "SAMD_TimerBatch.h"
+
+
+#define TIMER_FREQ_HZ           200000
+#define BATCH_SIZE              200
+
+volatile uint64_t lastPeriods = 0;
+
+// Init SAMD timer TIMER_TC3
+SAMDTimer ITimer(TIMER_TC3);
+
+SAMDTimerBatch batch;
+
+// Every BATCH_SIZE periods. 'periods' can be used to index sampled data, etc.
+void BatchHandler(const uint64_t& periods)
+{
+  lastPeriods = periods;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerInterruptBatching on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+
+  if (batch.begin(ITimer, TIMER_FREQ_HZ, BATCH_SIZE, BatchHandler))
+  {
+    Serial.print(F("Starting batch OK, timer Hz = ")); Serial.print(TIMER_FREQ_HZ);
+    Serial.print(F(", interrupts / s = ")); Serial.println(TIMER_FREQ_HZ / BATCH_SIZE);
+  }
+  else
+    Serial.println(F("Can't start batch. Select another freq. or batch size"));
+}
+
+void loop()
+{
+  static uint64_t lastPeriodCount = 0;
+  static uint32_t lastBatchCount  = 0;
+  
+  delay(1000);
+  
+  uint64_t periodCount  = batch.getPeriodCount();
+  uint32_t batchCount   = batch.getBatchCount();
+  
+  // Written by the handler in two halves
+  noInterrupts();
+  uint64_t periods      = lastPeriods;
+  interrupts();
+
+  // Should be TIMER_FREQ_HZ and TIMER_FREQ_HZ / BATCH_SIZE
+  Serial.print(F("Periods / s = ")); Serial.print((uint32_t) (periodCount - lastPeriodCount));
+  Serial.print(F(", interrupts / s = ")); Serial.print(batchCount - lastBatchCount);
+  // No 64-bit print(), a double holds the count exactly up to 2^53
+  Serial.print(F(", interrupts saved = ")); Serial.print((double) batch.getInterruptsSaved(), 0);
+  Serial.print(F(", last periods = ")); Serial.println((double) periods, 0);
+  
+  lastPeriodCount = periodCount;
+  lastBatchCount  = batchCount;
+}
@@ -0,0 +1,130 @@
+/****************************************************************************************************************************
+  TimerInterruptPriority.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   A critical 500us timer (TC3) competes with a long-running low-priority timer interrupt, SysTick doing 200us of work
+   every ms. Every few seconds, the TC3 priority alternates between the SysTick priority, where TC3 has to wait for the
+   SysTick work to end, and the highest priority, where TC3 preempts it. The latency probe shows the worst case each way.
+   The priority is set once per phase and survives the detachInterrupt() / reattachInterrupt() done in between.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+#define USING_LATENCY_PROBE           true
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+
+
+#define TIMER_INTERVAL_US       500
+#define LOW_PRIORITY_WORK_US    200
+
+#define PHASE_INTERVAL_MS       4000
+
+#define LOWEST_PRIORITY         (SAMD_NVIC_PRIORITY_LEVELS - 1)
+
+// Init SAMD timer TIMER_TC3
+SAMDTimer ITimer(TIMER_TC3);
+
+volatile uint32_t criticalCount = 0;
+
+void TimerHandler()
+{
+  criticalCount++;
+}
+
+// Called by the core at the start of each SysTick interrupt. Returning 0 lets millis() go on as usual
+extern "C" int sysTickHook()
+{
+  delayMicroseconds(LOW_PRIORITY_WORK_US);
+  
+  return 0;
+}
+
+void setCriticalPriority(const uint8_t& priority)
+{
+  ITimer.setInterruptPriority(priority);
+  
+  // The priority stays across detach / reattach
+  ITimer.detachInterrupt();
+  ITimer.reattachInterrupt();
+  
+  ITimer.resetLatencyStats();
+  
+  Serial.print(F("\nTC3 priority = ")); Serial.print(ITimer.getInterruptPriority());
+  Serial.print(F(", SysTick priority = ")); Serial.println(NVIC_GetPriority(SysTick_IRQn));
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerInterruptPriority on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+  
+  // The long-running interrupt at the lowest priority
+  NVIC_SetPriority(SysTick_IRQn, LOWEST_PRIORITY);
+
+  if (ITimer.attachInterruptInterval(TIMER_INTERVAL_US, TimerHandler))
+  {
+    Serial.print(F("Starting ITimer OK, micros() = ")); Serial.println(micros());
+  }
+  else
+    Serial.println(F("Can't set ITimer. Select another freq. or timer"));
+    
+  setCriticalPriority(LOWEST_PRIORITY);
+}
+
+void loop()
+{
+  static bool highPriority = false;
+  
+  delay(PHASE_INTERVAL_MS);
+  
+  SAMDLatencyStats stats;
+  
+  if (ITimer.getLatencyStats(stats))
+  {
+    // Up to LOW_PRIORITY_WORK_US at the same priority, a few hundred ns above it
+    Serial.print(F("TC3 latency us: avg = ")); Serial.print(stats.avgCycles / (F_CPU / 1000000), 2);
+    Serial.print(F(", worst = ")); Serial.print((float) stats.maxCycles / (F_CPU / 1000000), 2);
+    Serial.print(F(", callbacks = ")); Serial.println(criticalCount);
+  }
+  
+  highPriority = !highPriority;
+  
+  setCriticalPriority(highPriority ? 0 : LOWEST_PRIORITY);
+}
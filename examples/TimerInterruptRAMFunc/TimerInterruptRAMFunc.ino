@@ -0,0 +1,122 @@
+/****************************************************************************************************************************
+  TimerInterruptRAMFunc.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Measures the worst-case latency from the TC3 compare match to the callback with the library latency probe, while
+   loop() keeps evicting the flash wait-state buffer (SAMD21) or the cache (SAMD51) by reading all the flash.
+   Build once with USING_RAMFUNC_HANDLERS and USING_RAM_VECTOR_TABLE false and once with them true, and compare the
+   worst case and the jitter.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// Run TC3_Handler, and the callbacks marked SAMD_TIMER_RAMFUNC, from SRAM
+#define USING_RAMFUNC_HANDLERS        true
+
+// Fetch the vectors from SRAM as well
+#define USING_RAM_VECTOR_TABLE        true
+
+#define USING_LATENCY_PROBE           true
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+
+// DIV1, 48MHz ticks
+#define TIMER_INTERVAL_US       500
+
+// Init SAMD timer TIMER_TC3
+SAMDTimer ITimer(TIMER_TC3);
+
+// The probe measures up to the call, so nothing to do here
+SAMD_TIMER_RAMFUNC void TimerHandler()
+{
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerInterruptRAMFunc on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+  
+  Serial.print(F("Handlers in SRAM = ")); Serial.print(USING_RAMFUNC_HANDLERS);
+  Serial.print(F(", vector table in SRAM = ")); Serial.println(USING_RAM_VECTOR_TABLE);
+
+#if USING_RAM_VECTOR_TABLE
+  SAMD_useRAMVectorTable();
+#endif
+
+  if (ITimer.attachInterruptInterval(TIMER_INTERVAL_US, TimerHandler))
+  {
+    Serial.print(F("Starting ITimer OK, micros() = ")); Serial.println(micros());
+  }
+  else
+    Serial.println(F("Can't set ITimer. Select another freq. or timer"));
+}
+
+void loop()
+{
+  static uint32_t lastPrint = 0;
+  
+  // Read the whole flash, so the handler code is never left in the cache / prefetch buffer
+  const volatile uint32_t* flash  = (const volatile uint32_t*) FLASH_ADDR;
+  uint32_t                 sum    = 0;
+  
+  for (uint32_t i = 0; i < FLASH_SIZE / sizeof(uint32_t); i++)
+  {
+    sum += flash[i];
+  }
+  
+  if (millis() - lastPrint < 2000)
+    return;
+    
+  lastPrint = millis();
+  
+  SAMDLatencyStats stats;
+  
+  if (!ITimer.getLatencyStats(stats))
+    return;
+    
+  ITimer.resetLatencyStats();
+  
+  float nsPerCycle = 1000000000.0f / F_CPU;
+  
+  // The jitter (worst - best) is what the COUNT read overhead doesn't hide
+  Serial.print(F("Latency ns: best = ")); Serial.print(stats.minCycles * nsPerCycle, 0);
+  Serial.print(F(", worst = ")); Serial.print(stats.maxCycles * nsPerCycle, 0);
+  Serial.print(F(", jitter = ")); Serial.print((stats.maxCycles - stats.minCycles) * nsPerCycle, 0);
+  Serial.print(F(", flash sum = ")); Serial.println(sum, HEX);
+}
@@ -0,0 +1,132 @@
+/****************************************************************************************************************************
+  TimerInterruptStaticISR.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Compares the cost of the library TC3_Handler(), which calls the callback through a function pointer, with a handler
+   bound at compile time by SAMD_TIMER_ISR_TC3(), where the callback is inlined into the vector.
+   The timer runs at TIMER_FREQ_HZ while loop() spins a counter. Every CPU cycle spent entering, running and leaving
+   the ISR is lost from the spin loop, so the difference to an idle run gives the cycles used per interrupt.
+   Build once with USING_STATIC_HANDLER true and once with false, and compare the printed cycles / interrupt.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// true => callback inlined into TC3_Handler, false => library TC3_Handler calling through TC3_callback
+#define USING_STATIC_HANDLER          true
+
+#if USING_STATIC_HANDLER
+  // Must be defined before #include "SAMDTimerInterrupt.h" to drop the library TC3_Handler()
+  #define USING_TC3_STATIC_HANDLER
+#endif
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+
+#define TIMER_FREQ_HZ             100000.0f
+
+// Length of each spin measurement
+#define MEASURE_MS                1000
+
+volatile uint32_t tickCount = 0;
+
+// Init SAMD timer TIMER_TC3
+SAMDTimer ITimer(TIMER_TC3);
+
+// Kept trivial, so the handler overhead dominates
+void TimerHandler()
+{
+  tickCount++;
+}
+
+#if USING_STATIC_HANDLER
+  SAMD_TIMER_ISR_TC3(TimerHandler)
+#endif
+
+uint32_t spin()
+{
+  uint32_t count = 0;
+  uint32_t start = millis();
+
+  while (millis() - start < MEASURE_MS)
+    count++;
+
+  return count;
+}
+
+void measure()
+{
+  // Reference run, TC3 interrupt off
+  uint32_t idleCount = spin();
+
+  tickCount = 0;
+  ITimer.attachInterrupt(TIMER_FREQ_HZ, TimerHandler);
+
+  uint32_t loadedCount  = spin();
+  uint32_t ticks        = tickCount;
+
+  ITimer.detachInterrupt();
+  ITimer.disableTimer();
+
+  if ( (ticks == 0) || (loadedCount >= idleCount) )
+  {
+    Serial.println(F("No measurable ISR load"));
+    return;
+  }
+
+  float lostCycles = ( (float) F_CPU * MEASURE_MS / 1000 ) * (1.0f - (float) loadedCount / idleCount);
+
+  Serial.print(USING_STATIC_HANDLER ? F("Static handler") : F("Library handler"));
+  Serial.print(F(": interrupts = "));       Serial.print(ticks);
+  Serial.print(F(", idle spins = "));       Serial.print(idleCount);
+  Serial.print(F(", loaded spins = "));     Serial.print(loadedCount);
+  Serial.print(F(", cycles / interrupt = ")); Serial.println(lostCycles / ticks, 1);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerInterruptStaticISR on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+  Serial.print(F("Timer Frequency = ")); Serial.print(TIMER_FREQ_HZ); Serial.println(F(" Hz"));
+}
+
+void loop()
+{
+  measure();
+
+  delay(2000);
+}
@@ -0,0 +1,145 @@
+/****************************************************************************************************************************
+  TimerLatencyProbe.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Prints the latency distribution of each timer, from the compare match (TC3) or overflow (TCC) to the callback, as
+   recorded by the library latency probe. On SAMD21 both TC3 and TCC run, so each one's latency also shows the time
+   spent in the other's handler, as well as in the USB and SysTick interrupts.
+   Raise or lower the priority of a timer with NVIC_SetPriority() to see the effect on its worst case.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// Record the latency of every period. Also select the number and width of the histogram bins
+#define USING_LATENCY_PROBE           true
+#define SAMD_LATENCY_NUM_BINS         16
+#define SAMD_LATENCY_BIN_TICKS        4
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+
+
+// Both short enough for DIV1, so one tick is 1/48us
+#define TIMER0_INTERVAL_US      500
+#define TIMER1_INTERVAL_US      700
+
+#define PRINT_INTERVAL_MS       5000
+
+// Init SAMD timer TIMER_TC3
+SAMDTimer ITimer0(TIMER_TC3);
+
+#if (TIMER_INTERRUPT_USING_SAMD21)
+// Init SAMD timer TIMER_TCC
+SAMDTimer ITimer1(TIMER_TCC);
+#endif
+
+void TimerHandler0()
+{
+}
+
+void TimerHandler1()
+{
+}
+
+void printLatency(const char* name, SAMDTimer& timer)
+{
+  SAMDLatencyStats stats;
+  
+  if (!timer.getLatencyStats(stats))
+  {
+    Serial.print(name); Serial.println(F(": no sample"));
+    return;
+  }
+  
+  timer.resetLatencyStats();
+  
+  Serial.print(name); Serial.print(F(": periods = ")); Serial.print(stats.count);
+  Serial.print(F(", cycles min = ")); Serial.print(stats.minCycles);
+  Serial.print(F(", avg = ")); Serial.print(stats.avgCycles, 1);
+  Serial.print(F(", max = ")); Serial.println(stats.maxCycles);
+  
+  for (uint8_t bin = 0; bin < SAMD_LATENCY_NUM_BINS; bin++)
+  {
+    if (stats.histogram[bin] == 0)
+      continue;
+      
+    Serial.print(F("  ")); Serial.print(bin * stats.binCycles);
+    
+    if (bin == SAMD_LATENCY_NUM_BINS - 1)
+      Serial.print(F("+"));
+    else
+    {
+      Serial.print(F("-")); Serial.print((bin + 1) * stats.binCycles - 1);
+    }
+    
+    Serial.print(F(" cycles: ")); Serial.println(stats.histogram[bin]);
+  }
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerLatencyProbe on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+
+  if (ITimer0.attachInterruptInterval(TIMER0_INTERVAL_US, TimerHandler0))
+  {
+    Serial.print(F("Starting ITimer0 OK, micros() = ")); Serial.println(micros());
+  }
+  else
+    Serial.println(F("Can't set ITimer0. Select another freq. or timer"));
+
+#if (TIMER_INTERRUPT_USING_SAMD21)
+  if (ITimer1.attachInterruptInterval(TIMER1_INTERVAL_US, TimerHandler1))
+  {
+    Serial.print(F("Starting ITimer1 OK, micros() = ")); Serial.println(micros());
+  }
+  else
+    Serial.println(F("Can't set ITimer1. Select another freq. or timer"));
+#endif
+}
+
+void loop()
+{
+  delay(PRINT_INTERVAL_MS);
+  
+  printLatency("TC3", ITimer0);
+
+#if (TIMER_INTERRUPT_USING_SAMD21)
+  printLatency("TCC", ITimer1);
+#endif
+}
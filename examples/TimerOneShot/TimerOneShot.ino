@@ -0,0 +1,101 @@
+/****************************************************************************************************************************
+  TimerOneShot.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Phase-angle triac control. Each rising edge on ZERO_CROSS_PIN, from a mains zero-cross detector, arms a hardware
+   one-shot with fireOnceAfter(). FIRING_DELAY_US later the callback sends the gate pulse on TRIAC_PIN, and the timer
+   stops by itself, so no compare can fire a second time. As the delay doesn't change, every later call only issues
+   a RETRIGGER command. Without a detector, connect ZERO_CROSS_PIN to a 100Hz / 120Hz square wave.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+
+
+#define ZERO_CROSS_PIN            7
+#define TRIAC_PIN                 LED_BUILTIN
+
+// 5ms into a 10ms half-cycle => half power at 50Hz
+#define FIRING_DELAY_US           5000
+
+// Init SAMD timer TIMER_TC3
+SAMDTimer ITimer(TIMER_TC3);
+
+volatile uint32_t zeroCrossTime = 0;
+volatile uint32_t firingDelay   = 0;
+volatile uint32_t firingCount   = 0;
+
+void fireTriac()
+{
+  digitalWrite(TRIAC_PIN, HIGH);
+
+  firingDelay = micros() - zeroCrossTime;
+  firingCount++;
+
+  // Gate pulse of a few us is enough to latch the triac
+  delayMicroseconds(10);
+  digitalWrite(TRIAC_PIN, LOW);
+}
+
+void zeroCross()
+{
+  zeroCrossTime = micros();
+
+  ITimer.fireOnceAfter(FIRING_DELAY_US, fireTriac);
+}
+
+void setup()
+{
+  pinMode(TRIAC_PIN, OUTPUT);
+  pinMode(ZERO_CROSS_PIN, INPUT_PULLUP);
+
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerOneShot on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+
+  attachInterrupt(digitalPinToInterrupt(ZERO_CROSS_PIN), zeroCross, RISING);
+}
+
+void loop()
+{
+  delay(1000);
+
+  Serial.print(F("Firings = ")); Serial.print(firingCount);
+  Serial.print(F(", last delay (us) = ")); Serial.println(firingDelay);
+}
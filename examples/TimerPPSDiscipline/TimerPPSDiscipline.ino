@@ -0,0 +1,226 @@
+/****************************************************************************************************************************
+  TimerPPSDiscipline.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Disciplines the 48MHz timer clock with a 1 PPS reference, e.g. the PPS output of a GPS module, on pin 7.
+   TCC1 captures each reference period, and a PI loop turns the accumulated time error into a clock error in ppb,
+   with which the running timers are retuned. The 1kHz ITimer follows each new correction through its buffered compare
+   register, with ppb resolution, so it stays on the reference rate without a glitch.
+   Without a GPS, set USING_SIMULATED_PPS to true: the loop is then fed with a noisy simulated reference, 25ppm fast,
+   with a missed pulse, a 2ppm frequency step and a reference outage, and the sketch prints whether the loop converges,
+   tracks the step and holds over.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+#define USING_SIMULATED_PPS           false
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+#include "SAMD_TimerDiscipline.h"
+
+
+#define PPS_PIN               7
+
+#define TIMER_INTERVAL_US     1000L
+
+SAMDTimerCapture    Capture;
+SAMDTimerDiscipline Discipline;
+
+// Init SAMD timer TIMER_TC3
+SAMDTimer ITimer(TIMER_TC3);
+
+volatile uint32_t tickCount = 0;
+
+void TimerHandler()
+{
+  tickCount++;
+}
+
+void printState()
+{
+  static const char* stateName[] = { "OFF", "ACQUIRING", "LOCKED", "HOLDOVER" };
+  
+  Serial.print(stateName[Discipline.getState()]);
+  Serial.print(F(", pulses = "));       Serial.print(Discipline.getPulseCount());
+  Serial.print(F(", measured ppb = ")); Serial.print(Discipline.getMeasuredError());
+  Serial.print(F(", correction ppb = ")); Serial.print(Discipline.getCorrection());
+  Serial.print(F(", phase ns = "));     Serial.print(Discipline.getPhaseError(), 0);
+  Serial.print(F(", rejected = "));     Serial.println(Discipline.getRejectCount());
+}
+
+#if USING_SIMULATED_PPS
+
+#define SIM_TICK_HZ           6000000L
+
+// Ticks of one reference second for a clock 'errorPpb' fast, with about 50ns rms of reference jitter. The fraction
+// of a tick is carried over, as the real capture does
+uint32_t simulatedPeriod(const float& errorPpb)
+{
+  static float lastJitter = 0;
+  static float fraction   = 0;
+  
+  float jitter = 0;
+  
+  // Sum of uniform samples, close enough to a gaussian
+  for (uint8_t i = 0; i < 12; i++)
+    jitter += random(-1000, 1000) / 1000.0f;
+    
+  jitter *= 50.0f / 1.73f;
+  
+  float    ticks  = SIM_TICK_HZ + (errorPpb + jitter - lastJitter) * (SIM_TICK_HZ / 1e9f) + fraction;
+  uint32_t period = (uint32_t) ticks;
+  
+  fraction    = ticks - period;
+  lastJitter  = jitter;
+  
+  return period;
+}
+
+bool check(const __FlashStringHelper* name, const bool& passed)
+{
+  Serial.print(name); Serial.println(passed ? F(": PASS") : F(": FAIL"));
+  
+  return passed;
+}
+
+void simulate()
+{
+  float truth = 25000;
+  
+  Discipline.begin(SIM_TICK_HZ);
+  
+  for (uint16_t pulse = 0; pulse < 200; pulse++)
+  {
+    if (pulse == 100)
+      truth += 2000;
+    
+    if ( (pulse >= 150) && (pulse < 160) )
+    {
+      // Reference lost
+      Discipline.handlePulse(0);
+      continue;
+    }
+    
+    uint32_t period = simulatedPeriod(truth);
+    
+    // A missed pulse looks like a 2s period
+    Discipline.handlePulse( (pulse == 60) ? 2 * period : period );
+    
+    if (pulse == 59)
+    {
+      printState();
+      check(F("Converged within 60 pulses"), (Discipline.getState() == SAMD_DISCIPLINE_LOCKED) && 
+                                              (abs(Discipline.getCorrection() - truth) < 300));
+    }
+    else if (pulse == 61)
+    {
+      check(F("Missed pulse rejected"), Discipline.getRejectCount() == 1);
+    }
+    else if (pulse == 149)
+    {
+      printState();
+      check(F("Tracked the 2ppm step"), (Discipline.getState() == SAMD_DISCIPLINE_LOCKED) && 
+                                         (abs(Discipline.getCorrection() - truth) < 300));
+    }
+    else if (pulse == 199)
+    {
+      printState();
+      check(F("Locked again after the outage"), Discipline.getState() == SAMD_DISCIPLINE_LOCKED);
+    }
+    
+    if (pulse == 150)
+    {
+      printState();
+      check(F("Holdover keeps the estimate"), (Discipline.getState() == SAMD_DISCIPLINE_HOLDOVER) && 
+                                               (abs(Discipline.getCorrection() - truth) < 300));
+    }
+  }
+  
+  Discipline.end();
+  
+  // Back to the nominal clock for the real timers
+  SAMD_setClockError(0);
+}
+
+#endif
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerPPSDiscipline on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+  
+#if USING_SIMULATED_PPS
+  simulate();
+#else
+  if (Discipline.begin(Capture, PPS_PIN))
+  {
+    Serial.print(F("Disciplining with the PPS on pin ")); Serial.println(PPS_PIN);
+  }
+  else
+    Serial.println(F("Can't capture the PPS pin. Select an external interrupt pin"));
+#endif
+
+  if (ITimer.attachInterruptInterval(TIMER_INTERVAL_US, TimerHandler))
+  {
+    Serial.print(F("Starting ITimer OK, millis() = ")); Serial.println(millis());
+  }
+  else
+    Serial.println(F("Can't set ITimer. Select another freq. or timer"));
+}
+
+void loop()
+{
+  static uint32_t lastPulses    = 0;
+  static uint32_t lastTicks     = 0;
+  
+  uint32_t pulses = Discipline.getPulseCount();
+  
+  if (pulses == lastPulses)
+    return;
+    
+  // One reference second elapsed
+  uint32_t ticks = tickCount;
+  
+  printState();
+  
+  Serial.print(F("ITimer periods in the last PPS second = ")); Serial.println(ticks - lastTicks);
+  
+  lastPulses  = pulses;
+  lastTicks   = ticks;
+}
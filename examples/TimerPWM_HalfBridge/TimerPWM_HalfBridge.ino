@@ -0,0 +1,111 @@
+/****************************************************************************************************************************
+  TimerPWM_HalfBridge.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Drives a half-bridge with 20kHz center-aligned PWM from TCC0, with 500ns dead time between the two complementary
+   outputs, and sweeps the duty cycle without any CPU work per period. Each new duty is buffered by the hardware and
+   applied at the next period boundary, so no period is ever cut short.
+   LOW_SIDE_PIN must be on TCC0 WO[n] and HIGH_SIDE_PIN on TCC0 WO[n + 4], n = 0-3, as listed by your board variant
+   (pin 4 = PA08 = WO[0] on Arduino Zero). TCC0 can't be used by SAMDTimer(TIMER_TCC) or analogWrite() at the same time.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+#include "SAMD_TimerPWM.h"
+
+
+#define LOW_SIDE_PIN              4
+#define HIGH_SIDE_PIN             10
+
+#define PWM_FREQ_HZ               20000
+#define DEAD_TIME_NS              500
+
+SAMDTimerPWM bridgePWM;
+
+int8_t bridgeChannel = -1;
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerPWM_HalfBridge on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+
+  bridgeChannel = bridgePWM.attachPin(LOW_SIDE_PIN);
+
+  if ( (bridgeChannel < 0) || (bridgeChannel >= SAMD_PWM_NUM_DTI_CHANNELS) || (bridgePWM.attachPin(HIGH_SIDE_PIN) != bridgeChannel) )
+  {
+    Serial.println(F("Can't attach pins. Select a TCC0 WO[n] / WO[n + 4] pair of your board"));
+    bridgeChannel = -1;
+
+    return;
+  }
+
+  // Before begin(), so the outputs never run without dead time
+  bridgePWM.setDeadTime(bridgeChannel, DEAD_TIME_NS, DEAD_TIME_NS);
+
+  if (bridgePWM.begin(PWM_FREQ_HZ, SAMD_PWM_DUAL_SLOPE))
+  {
+    Serial.print(F("Starting bridgePWM OK, frequency = ")); Serial.print(bridgePWM.getFrequency());
+    Serial.print(F(", resolution = ")); Serial.println(bridgePWM.getTop());
+  }
+  else
+    Serial.println(F("Can't start bridgePWM. Select another frequency"));
+}
+
+void loop()
+{
+  static float duty = 0;
+  static float step = 1;
+
+  if (bridgeChannel < 0)
+    return;
+
+  bridgePWM.setDuty(bridgeChannel, duty);
+
+  duty += step;
+
+  if ( (duty >= 100) || (duty <= 0) )
+  {
+    step = -step;
+
+    Serial.print(F("Duty = ")); Serial.println(duty);
+  }
+
+  delay(20);
+}
@@ -0,0 +1,134 @@
+/****************************************************************************************************************************
+  TimerRestartFirstPeriod.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Checks that restartTimer() always starts a full period. A 1ms periodic timer is repeatedly stopped with
+   stopTimer() at an arbitrary point of its period, then restarted with restartTimer() after a random pause, and the
+   time from the restart to the first callback is compared with TIMER_INTERVAL_US. Any stale count or pending match
+   left by the stop would show up as a short first period.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+
+
+#define TIMER_INTERVAL_US         1000
+
+// micros() resolution plus interrupt latency
+#define TOLERANCE_US              4
+
+#define NUMBER_OF_RUNS            100
+
+// Init SAMD timer TIMER_TC3
+SAMDTimer ITimer(TIMER_TC3);
+
+volatile uint32_t firstCallbackTime = 0;
+volatile bool     waitingFirst      = false;
+
+void TimerHandler()
+{
+  if (waitingFirst)
+  {
+    firstCallbackTime = micros();
+    waitingFirst      = false;
+  }
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerRestartFirstPeriod on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+
+  if (ITimer.attachInterruptInterval(TIMER_INTERVAL_US, TimerHandler))
+  {
+    Serial.print(F("Starting ITimer OK, interval (us) = ")); Serial.println(TIMER_INTERVAL_US);
+  }
+  else
+  {
+    Serial.println(F("Can't set ITimer. Select another freq. or timer"));
+
+    return;
+  }
+
+  uint16_t failures = 0;
+  uint32_t minPeriod = 0xFFFFFFFF;
+  uint32_t maxPeriod = 0;
+
+  for (uint16_t run = 0; run < NUMBER_OF_RUNS; run++)
+  {
+    // Stop somewhere inside a period
+    delayMicroseconds(random(TIMER_INTERVAL_US));
+    ITimer.stopTimer();
+
+    delayMicroseconds(random(2 * TIMER_INTERVAL_US));
+
+    noInterrupts();
+    waitingFirst = true;
+    ITimer.restartTimer();
+    uint32_t restartTime = micros();
+    interrupts();
+
+    while (waitingFirst);
+
+    uint32_t firstPeriod = firstCallbackTime - restartTime;
+
+    if (firstPeriod < minPeriod)
+      minPeriod = firstPeriod;
+
+    if (firstPeriod > maxPeriod)
+      maxPeriod = firstPeriod;
+
+    if ( (firstPeriod + TOLERANCE_US < TIMER_INTERVAL_US) || (firstPeriod > TIMER_INTERVAL_US + TOLERANCE_US) )
+    {
+      failures++;
+
+      Serial.print(F("Run ")); Serial.print(run); Serial.print(F(": first period (us) = ")); Serial.println(firstPeriod);
+    }
+  }
+
+  Serial.print(F("First period (us) min = ")); Serial.print(minPeriod);
+  Serial.print(F(", max = ")); Serial.println(maxPeriod);
+
+  Serial.println(failures ? F("FAIL") : F("PASS"));
+}
+
+void loop()
+{
+}
@@ -0,0 +1,173 @@
+/****************************************************************************************************************************
+  TimerRunLimit.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Runs a timer for a fixed number of periods, or a fixed duration, with no bookkeeping in the callback.
+   The library handler counts the periods down, stops the timer after the last one and calls the done callback.
+   - a burst of 10 LED blinks: attachInterruptIntervalCount(50ms, ..., 20 toggles, BurstDone)
+   - a 250ms capture of a pin, sampled every 1ms: attachInterruptInterval(1000us, ..., 250ms, CaptureDone)
+   Both restart every 5s with a new attach.
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+
+
+
+#if !defined(LED_BUILTIN)
+  #define LED_BUILTIN       13
+#endif
+
+#define CAPTURE_PIN         7
+
+#define BLINK_INTERVAL_US   50000L
+#define BLINK_TOGGLES       20
+
+#define SAMPLE_INTERVAL_US  1000L
+#define CAPTURE_DURATION_MS 250
+
+#define RESTART_MS          5000L
+
+volatile uint32_t sampleCount = 0;
+volatile uint32_t highCount   = 0;
+
+volatile bool burstDone   = false;
+volatile bool captureDone = false;
+
+// Init SAMD timer TIMER_TC3
+SAMDTimer ITimer(TIMER_TC3);
+
+void BlinkHandler()
+{
+  digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+}
+
+// Called once, in ISR context, right after the last toggle. The timer is already stopped
+void BurstDone()
+{
+  burstDone = true;
+}
+
+void SampleHandler()
+{
+  sampleCount++;
+  
+  if (digitalRead(CAPTURE_PIN))
+    highCount++;
+}
+
+void CaptureDone()
+{
+  captureDone = true;
+}
+
+void startBurst()
+{
+  burstDone = false;
+  
+  // 20 toggles = 10 blinks, then BurstDone()
+  if (ITimer.attachInterruptIntervalCount(BLINK_INTERVAL_US, BlinkHandler, BLINK_TOGGLES, BurstDone))
+  {
+    Serial.print(F("Burst started, remaining runs = ")); Serial.println(ITimer.getRemainingRuns());
+  }
+  else
+    Serial.println(F("Can't set ITimer. Select another freq. or timer"));
+}
+
+void startCapture()
+{
+  sampleCount = 0;
+  highCount   = 0;
+  captureDone = false;
+  
+  // 250ms / 1ms = 250 samples, then CaptureDone()
+  if (ITimer.attachInterruptInterval(SAMPLE_INTERVAL_US, SampleHandler, CAPTURE_DURATION_MS, CaptureDone))
+  {
+    Serial.print(F("Capture started, remaining runs = ")); Serial.println(ITimer.getRemainingRuns());
+  }
+  else
+    Serial.println(F("Can't set ITimer. Select another freq. or timer"));
+}
+
+void setup()
+{
+  pinMode(LED_BUILTIN, OUTPUT);
+  pinMode(CAPTURE_PIN, INPUT_PULLUP);
+  
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerRunLimit on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+
+  startBurst();
+}
+
+void loop()
+{
+  static uint32_t lastStart   = millis();
+  static bool     doCapture   = true;
+  
+  if (burstDone)
+  {
+    burstDone = false;
+    
+    Serial.print(F("Burst done after ")); Serial.print(millis() - lastStart); Serial.println(F(" ms"));
+  }
+  
+  if (captureDone)
+  {
+    captureDone = false;
+    
+    Serial.print(F("Capture done after ")); Serial.print(millis() - lastStart);
+    Serial.print(F(" ms, samples = ")); Serial.print(sampleCount);
+    Serial.print(F(", high = ")); Serial.println(highCount);
+  }
+  
+  if (millis() - lastStart >= RESTART_MS)
+  {
+    lastStart = millis();
+    
+    // Alternate between both kinds of limit, each with a plain new attach
+    if (doCapture)
+      startCapture();
+    else
+      startBurst();
+      
+    doCapture = !doCapture;
+  }
+}
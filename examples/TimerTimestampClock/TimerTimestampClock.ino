@@ -0,0 +1,175 @@
+/****************************************************************************************************************************
+  TimerTimestampClock.ino
+  For SAMD boards
+  Written by Khoi Hoang
+  
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+  
+  Now even you use all these new 16 ISR-based timers,with their maximum interval practically unlimited (limited only by
+  unsigned long miliseconds), you just consume only one SAMD timer and avoid conflicting with other cores' tasks.
+  The accuracy is nearly perfect compared to software timers. The most important feature is they're ISR-based timers
+  Therefore, their executions are not blocked by bad-behaving functions / tasks.
+  This important feature is absolutely necessary for mission-critical tasks.
+*****************************************************************************************************************************/
+
+/*
+   Notes:
+   Starts the 64-bit timestamp clock, a free-running 32-bit TC pair at 48MHz extended by its overflow interrupt, then:
+   - compares the cost of now64() / nowNs() with micros()
+   - times a TC3 interrupt period with nanosecond resolution, from inside the ISR
+   - checks every second that the clock is monotonic and agrees with millis()
+   On SAMD21 the clock uses TC4/TC5, so it can't run with SAMDTimerFreqCounter, Servo or tone().
+*/
+
+#if !( defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000) || defined(ARDUINO_SAMD_MKRWIFI1010) \
+      || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_SAMD_MKRFox1200) || defined(ARDUINO_SAMD_MKRWAN1300) || defined(ARDUINO_SAMD_MKRWAN1310) \
+      || defined(ARDUINO_SAMD_MKRGSM1400) || defined(ARDUINO_SAMD_MKRNB1500) || defined(ARDUINO_SAMD_MKRVIDOR4000) \
+      || defined(ARDUINO_SAMD_CIRCUITPLAYGROUND_EXPRESS) || defined(__SAMD51__) || defined(__SAMD51J20A__) \
+      || defined(__SAMD51J19A__) || defined(__SAMD51G19A__) || defined(__SAMD51P19A__)  \
+      || defined(__SAMD21E15A__) || defined(__SAMD21E16A__) || defined(__SAMD21E17A__) || defined(__SAMD21E18A__) \
+      || defined(__SAMD21G15A__) || defined(__SAMD21G16A__) || defined(__SAMD21G17A__) || defined(__SAMD21G18A__) \
+      || defined(__SAMD21J15A__) || defined(__SAMD21J16A__) || defined(__SAMD21J17A__) || defined(__SAMD21J18A__) )
+  #error This code is designed to run on SAMD21/SAMD51 platform! Please check your Tools->Board setting.
+#endif
+
+// These define's must be placed at the beginning before #include "SAMDTimerInterrupt.h"
+// _TIMERINTERRUPT_LOGLEVEL_ from 0 to 4
+// Don't define _TIMERINTERRUPT_LOGLEVEL_ > 0. Only for special ISR debugging only. Can hang the system.
+// Don't define TIMER_INTERRUPT_DEBUG > 2. Only for special ISR debugging only. Can hang the system.
+#define TIMER_INTERRUPT_DEBUG         0
+#define _TIMERINTERRUPT_LOGLEVEL_     0
+
+// To be included only in main(), .ino with setup() to avoid `Multiple Definitions` Linker Error
+#include "SAMDTimerInterrupt.h"
+#include "SAMD_TimerTimestamp.h"
+
+
+#define TIMER_INTERVAL_US     1000L
+
+#define NUMBER_OF_CALLS       1000
+
+SAMDTimestampClock Clock;
+
+// Init SAMD timer TIMER_TC3
+SAMDTimer ITimer(TIMER_TC3);
+
+volatile uint64_t lastTick      = 0;
+volatile uint32_t minPeriodNs   = 0xFFFFFFFF;
+volatile uint32_t maxPeriodNs   = 0;
+
+void TimerHandler()
+{
+  uint64_t now = Clock.now64();
+  
+  if (lastTick != 0)
+  {
+    uint32_t periodNs = Clock.ticksToNs(now - lastTick);
+    
+    if (periodNs < minPeriodNs)
+      minPeriodNs = periodNs;
+      
+    if (periodNs > maxPeriodNs)
+      maxPeriodNs = periodNs;
+  }
+  
+  lastTick = now;
+}
+
+// SysTick->VAL counts down from SysTick->LOAD, good for anything shorter than 1ms
+uint32_t cyclesSince(const uint32_t& start)
+{
+  uint32_t now = SysTick->VAL;
+  
+  return (start >= now) ? (start - now) : (start + SysTick->LOAD + 1 - now);
+}
+
+void printCost(const __FlashStringHelper* name, const uint32_t& cycles)
+{
+  Serial.print(name); Serial.print(F(" = ")); Serial.print((float) cycles / NUMBER_OF_CALLS, 1);
+  Serial.println(F(" cycles per call"));
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  delay(100);
+
+  Serial.print(F("\nStarting TimerTimestampClock on ")); Serial.println(BOARD_NAME);
+  Serial.println(SAMD_TIMER_INTERRUPT_VERSION);
+  Serial.print(F("CPU Frequency = ")); Serial.print(F_CPU / 1000000); Serial.println(F(" MHz"));
+  
+  if (!Clock.begin())
+  {
+    Serial.println(F("Can't start the timestamp clock"));
+    while (true);
+  }
+  
+  Serial.print(F("Tick frequency (Hz) = ")); Serial.println(Clock.getTickFrequency());
+  
+  volatile uint64_t sink = 0;
+  
+  // Short enough to stay within one SysTick reload
+  uint32_t start = SysTick->VAL;
+  
+  for (uint16_t i = 0; i < NUMBER_OF_CALLS / 10; i++)
+    sink += Clock.now64();
+    
+  printCost(F("now64()"), cyclesSince(start) * 10);
+  
+  start = SysTick->VAL;
+  
+  for (uint16_t i = 0; i < NUMBER_OF_CALLS / 10; i++)
+    sink += Clock.nowNs();
+    
+  printCost(F("nowNs()"), cyclesSince(start) * 10);
+  
+  start = SysTick->VAL;
+  
+  for (uint16_t i = 0; i < NUMBER_OF_CALLS / 10; i++)
+    sink += micros();
+    
+  printCost(F("micros()"), cyclesSince(start) * 10);
+
+  if (ITimer.attachInterruptInterval(TIMER_INTERVAL_US, TimerHandler))
+  {
+    Serial.print(F("Starting ITimer OK, millis() = ")); Serial.println(millis());
+  }
+  else
+    Serial.println(F("Can't set ITimer. Select another freq. or timer"));
+}
+
+void loop()
+{
+  static uint64_t lastNs      = Clock.nowNs();
+  static uint32_t lastMillis  = millis();
+  
+  delay(1000);
+  
+  uint64_t nowNs      = Clock.nowNs();
+  uint32_t nowMillis  = millis();
+  
+  if (nowNs <= lastNs)
+    Serial.println(F("Error: clock went backwards"));
+  
+  noInterrupts();
+  
+  uint32_t minNs = minPeriodNs;
+  uint32_t maxNs = maxPeriodNs;
+  
+  minPeriodNs = 0xFFFFFFFF;
+  maxPeriodNs = 0;
+  
+  interrupts();
+  
+  // Both should agree within a ms
+  Serial.print(F("Clock us = ")); Serial.print((uint32_t) ((nowNs - lastNs) / 1000));
+  Serial.print(F(", millis() us = ")); Serial.print((nowMillis - lastMillis) * 1000);
+  Serial.print(F(", ITimer period ns min = ")); Serial.print(minNs);
+  Serial.print(F(", max = ")); Serial.println(maxNs);
+  
+  lastNs      = nowNs;
+  lastMillis  = nowMillis;
+}
@@ -158,8 +158,184 @@
 
 #include "TimerInterrupt_Generic_Debug.h"
 
+// Define USING_RAMFUNC_HANDLERS true before including "SAMDTimerInterrupt.h" to run TC3_Handler, TCC0_Handler and
+// SAMD_ISR_Timer::run() from SRAM, free of flash wait states and SAMD51 cache misses. The startup code copies the
+// .ramfunc section to SRAM with .data, and the linker adds a long-branch stub to calls between flash and SRAM.
+// SAMD_TIMER_RAMFUNC can also be put on time-critical callbacks
+#ifndef SAMD_TIMER_RAMFUNC
+  #if (defined(USING_RAMFUNC_HANDLERS) && USING_RAMFUNC_HANDLERS)
+    #define SAMD_TIMER_RAMFUNC      __attribute__((section(".ramfunc"), noinline))
+  #else
+    #define SAMD_TIMER_RAMFUNC
+  #endif
+#endif
+
+// Copy the vector table to SRAM and point VTOR at it, so that the vector fetch on interrupt entry doesn't wait for
+// flash either. Call once in setup(), before attaching. Costs 256 (SAMD21) / 1024 (SAMD51) bytes of SRAM
+bool SAMD_useRAMVectorTable();
+
+// Default (nominal) frequency of the GCLK generator feeding the timers. Use setClockSource() to select another
+// generator, such as the 120MHz GCLK0 on SAMD51 or a 32.768kHz generator for very long periods
 #define TIMER_HZ      48000000L
 
+// Measured error of the timer clock, in ppb: real frequency = nominal * (1 + error / 1e9). Set by SAMD_calibrateClock(),
+// SAMDTimerDiscipline or the user, and used by the period math of each attach from then on. Running periodic timers
+// are retuned at once, see applyClockError(). SAMD_ISR_Timer counts millis() and isn't corrected. Only meaningful for
+// generators running from the measured oscillator, the DFLL48M by default
+extern volatile int32_t SAMD_clockErrorPpb;
+
+void    SAMD_setClockError(const int32_t& ppb);
+int32_t SAMD_getClockError();
+
+// TC and TCC share the same prescaler encoding: PRESCALER field value n divides the clock by SAMD_prescalerDivider[n]
+static const uint16_t SAMD_prescalerDivider[8] = { 1, 2, 4, 8, 16, 64, 256, 1024 };
+
+// Smallest PRESCALER field value for which 'period' (us) fits in maxCount ticks of a timerHz clock. DIV1024 if none fits
+static inline uint8_t SAMD_selectPrescaler(const float& period, const uint32_t& timerHz, const uint32_t& maxCount)
+{
+  float ticks = period * (timerHz / 1000000.0f);
+  
+  for (uint8_t index = 0; index < 7; index++)
+  {
+    if ( ticks / SAMD_prescalerDivider[index] <= maxCount )
+      return index;
+  }
+  
+  return 7;
+}
+
+// PRESCALER field value used by the periodic modes for 'period' (us), scaled to a TIMER_HZ clock
+static inline uint8_t SAMD_periodPrescalerIndex(const float& scaledPeriod)
+{
+  // Upper bound (us) of each prescaler, DIV1 to DIV256
+  static const float maxPeriod[7] = { 1000, 2500, 5000, 10000, 20000, 80000, 300000 };
+  
+  for (uint8_t index = 0; index < 7; index++)
+  {
+    if (scaledPeriod <= maxPeriod[index])
+      return index;
+  }
+  
+  return 7;
+}
+
+// Steps of setPeriodAsync(), each started by pollPeriodAsync() once the previous register write is synchronized
+typedef enum
+{
+  SAMD_ASYNC_IDLE = 0,
+  SAMD_ASYNC_DISABLE,         // ENABLE = 0, CTRLA is enable-protected
+  SAMD_ASYNC_PRESCALER,       // CTRLA with the new prescaler
+  SAMD_ASYNC_COMPARE,         // CC0 (TC3) or PER (TCC)
+  SAMD_ASYNC_COUNT,           // COUNT = 0
+  SAMD_ASYNC_ENABLE,          // ENABLE = 1
+  SAMD_ASYNC_FINISH           // last write synchronized
+} SAMDAsyncState;
+
+// Callback with context of one hardware timer, see attachInterruptInterval(interval, callback, param)
+typedef struct
+{
+  void  (*callback) (void*);
+  void* param;
+} SAMDTimerDispatch;
+
+// NVIC priority levels of the timer interrupts: 4 on SAMD21, 8 on SAMD51. 0 is the highest
+#define SAMD_NVIC_PRIORITY_LEVELS     (1 << __NVIC_PRIO_BITS)
+
+// setInterruptPriority() not called, the priority is left as set by the core or the sketch
+#define SAMD_NVIC_PRIORITY_UNSET      0xFF
+
+// Interrupt latency probe. Define USING_LATENCY_PROBE true before including "SAMDTimerInterrupt.h" and the library
+// handler reads the timer COUNT right before calling the callback of each period. The counter restarted at the match
+// (TC3) or overflow (TCC), so COUNT is the latency from the hardware event to the callback, the COUNT read included.
+// The resolution is one timer tick, so keep the period short enough for DIV1, below 1000us at 48MHz
+#if !defined(USING_LATENCY_PROBE)
+  #define USING_LATENCY_PROBE         false
+#endif
+
+#ifndef SAMD_LATENCY_NUM_BINS
+  #define SAMD_LATENCY_NUM_BINS       16
+#endif
+
+// Width of each histogram bin, in timer ticks
+#ifndef SAMD_LATENCY_BIN_TICKS
+  #define SAMD_LATENCY_BIN_TICKS      4
+#endif
+
+// Samples in timer ticks, written by the handler
+typedef struct
+{
+  volatile uint32_t count;
+  volatile uint32_t minTicks;
+  volatile uint32_t maxTicks;
+  volatile uint64_t sumTicks;
+  volatile uint32_t histogram[SAMD_LATENCY_NUM_BINS];
+} SAMDLatencyProbe;
+
+// Snapshot returned by getLatencyStats(), in CPU cycles
+typedef struct
+{
+  uint32_t  count;                                // periods recorded
+  uint32_t  minCycles;
+  uint32_t  maxCycles;
+  float     avgCycles;
+  uint32_t  binCycles;                            // width of each histogram bin
+  uint32_t  histogram[SAMD_LATENCY_NUM_BINS];     // the last bin also holds everything above it
+} SAMDLatencyStats;
+
+static inline void SAMD_resetLatency(SAMDLatencyProbe& probe)
+{
+  noInterrupts();
+  
+  probe.count     = 0;
+  probe.minTicks  = 0xFFFFFFFF;
+  probe.maxTicks  = 0;
+  probe.sumTicks  = 0;
+  
+  for (uint8_t bin = 0; bin < SAMD_LATENCY_NUM_BINS; bin++)
+  {
+    probe.histogram[bin] = 0;
+  }
+  
+  interrupts();
+}
+
+static inline void SAMD_recordLatency(SAMDLatencyProbe& probe, const uint32_t& ticks)
+{
+  uint32_t bin = ticks / SAMD_LATENCY_BIN_TICKS;
+  
+  probe.histogram[ (bin < SAMD_LATENCY_NUM_BINS) ? bin : (SAMD_LATENCY_NUM_BINS - 1) ]++;
+  
+  probe.count++;
+  probe.sumTicks += ticks;
+  
+  if (ticks < probe.minTicks)
+    probe.minTicks = ticks;
+    
+  if (ticks > probe.maxTicks)
+    probe.maxTicks = ticks;
+}
+
+// Copy 'probe' into 'stats', converting ticks of the timer clock to CPU cycles. false if nothing recorded yet
+static inline bool SAMD_readLatency(SAMDLatencyProbe& probe, const float& cyclesPerTick, SAMDLatencyStats& stats)
+{
+  noInterrupts();
+  
+  stats.count       = probe.count;
+  stats.minCycles   = (uint32_t) (probe.minTicks * cyclesPerTick);
+  stats.maxCycles   = (uint32_t) (probe.maxTicks * cyclesPerTick);
+  stats.avgCycles   = probe.count ? (float) probe.sumTicks * cyclesPerTick / probe.count : 0;
+  stats.binCycles   = (uint32_t) (SAMD_LATENCY_BIN_TICKS * cyclesPerTick);
+  
+  for (uint8_t bin = 0; bin < SAMD_LATENCY_NUM_BINS; bin++)
+  {
+    stats.histogram[bin] = probe.histogram[bin];
+  }
+  
+  interrupts();
+  
+  return (stats.count != 0);
+}
+
 ////////////////////////////////////////////////////
 
 #if (TIMER_INTERRUPT_USING_SAMD51)
@@ -175,9 +351,22 @@ class SAMDTimerInterrupt;
 typedef SAMDTimerInterrupt SAMDTimer;
 
 typedef void (*timerCallback)  ();
+typedef void (*timerCallback_p)(void*);
 
 #define SAMD_TC3        ((TcCount16*) _SAMDTimer)
 
+// Compare channels usable by beginCompareChannels()
+#define SAMD_TC3_NUM_CHANNELS     2
+
+// The Cortex-M4 NVIC can split each priority into a preemption priority and a subpriority. Keep 'preemptionBits' of
+// the 3 priority bits for preemption (3, the reset default: all 8 levels preempt each other), the rest only orders
+// pending interrupts of the same preemption priority. Applies to all the interrupts, not only the timers
+static inline void SAMD_setPriorityGrouping(const uint8_t& preemptionBits)
+{
+  // PRIGROUP n => bits [7:n+1] of the 8-bit priority field are the preemption priority
+  NVIC_SetPriorityGrouping(7 - ((preemptionBits < __NVIC_PRIO_BITS) ? preemptionBits : __NVIC_PRIO_BITS));
+}
+
 static inline void TC3_wait_for_sync() 
 {
   while (TC3->COUNT16.SYNCBUSY.reg != 0);
@@ -194,10 +383,58 @@ class SAMDTimerInterrupt
     timerCallback   _callback;        // pointer to the callback function
     
     int             _prescaler;
+    
+    float           _frequencyError;  // residual error (Hz) of the last setFrequencyExact()
+    
+    uint8_t         _gclkGenerator;   // GCLK generator feeding the timer, GCLK1 (48MHz) by default
+    uint32_t        _timerHz;         // frequency of that generator, used by all period math
+    
+    bool            _compareChannels; // true after beginCompareChannels(), until the next periodic attach
+    
+    float           _oneShotDelay;    // delay (us) of the armed fireOnceAfter(), 0 => periodic mode
+    
+    bool            initialized;      // periodic mode set up, only the period changes on the next attach
+    
+    float           _lastPeriod;      // period (us) of the last periodic attach, 0 => CC / PER changed since
+    int32_t         _lastClockError;  // SAMD_clockErrorPpb used by that attach
+    double          _trimPeriod;      // period (us) applyClockError() keeps on the corrected clock, 0 => none
+    
+    SAMDAsyncState  _asyncState;      // setPeriodAsync() progress
+    uint8_t         _asyncPrescaler;
+    uint16_t        _asyncCompare;
+    
+    uint8_t         _priority;        // NVIC priority, SAMD_NVIC_PRIORITY_UNSET => left as is
+    
+    uint32_t        _runLimit;        // periods to run for the next attach only, 0 => indefinitely
+    timerCallback   _doneCallback;    // called by the handler once _runLimit periods have run
+    
+    // Set the periodic callback, and arm the run limit of attachInterruptIntervalCount() if any
+    void setCallback(timerCallback callback);
+    
+    // _timerHz corrected by SAMD_clockErrorPpb, for all tick counts
+    double clockHz()
+    {
+      return _timerHz * (1.0 + SAMD_clockErrorPpb * 1e-9);
+    }
+    
+    // Store callback / param in the dispatch table entry of this timer, and return the dispatcher to attach
+    timerCallback setDispatch(timerCallback_p callback, void* param);
+    
+    // Every attach / reattach path enables the IRQ through here, so the priority survives detachInterrupt()
+    void enableIRQ()
+    {
+      if (_priority != SAMD_NVIC_PRIORITY_UNSET)
+        NVIC_SetPriority(TC3_IRQn, _priority);
+        
+      NVIC_EnableIRQ(TC3_IRQn);
+    }
 
   public:
 
-    SAMDTimerInterrupt(const SAMDTimerNumber& timerNumber)
+    SAMDTimerInterrupt(const SAMDTimerNumber& timerNumber) : _prescaler(1), _frequencyError(0), _gclkGenerator(1), _timerHz(TIMER_HZ),
+      _compareChannels(false), _oneShotDelay(0), initialized(false), _lastPeriod(0), _lastClockError(0), _trimPeriod(0),
+      _asyncState(SAMD_ASYNC_IDLE), _priority(SAMD_NVIC_PRIORITY_UNSET),
+      _runLimit(0), _doneCallback(NULL)
     {
       _timerNumber = timerNumber;
            
@@ -209,15 +446,139 @@ class SAMDTimerInterrupt
       _callback = NULL;      
     };
     
-    ~SAMDTimerInterrupt()
-    {
-    }
+    ~SAMDTimerInterrupt();
 
     bool setFrequency(const float& frequency, timerCallback callback);
     bool _setPeriod(const float& _period, timerCallback callback);
+    
+    // Fractional-period mode. The ISR runs a 32-bit phase accumulator and alternates CC between N and N+1 ticks,
+    // so the long-term average frequency is exact, with at most one timer tick of jitter on any single period
+    bool setFrequencyExact(const float& frequency, timerCallback callback);
+    
+    // Retune the running periodic timer to SAMD_clockErrorPpb through the buffered CC / PER, with the sub-tick part in
+    // the phase accumulator. Called by SAMD_setClockError() for the last timer attached on each TC / TCC
+    bool applyClockError();
+
+    // Residual error (in Hz, achieved - requested) of the average frequency set by the last setFrequencyExact()
+    float getFrequencyError()
+    {
+      return _frequencyError;
+    }
+
+    // Glitch-free retuning of a running timer. Only CCBUF is written, and the hardware latches it at the next
+    // overflow, so the current period always completes. The prescaler is kept, so the new period must fit in it
+    bool setPeriodBuffered(const float& period);
+    
+    bool setFrequencyBuffered(const float& frequency)
+    {
+      return setPeriodBuffered(1000000.0f / frequency);
+    }
+    
+    // Non-blocking retune of an attached periodic timer. Returns at once without waiting for any register
+    // synchronization; call pollPeriodAsync(), e.g. from loop(), until it returns true. With an unchanged prescaler
+    // the new period goes through the buffer and is already complete. A prescaler change restarts the period from 0
+    bool setPeriodAsync(const float& period);
+    
+    bool setFrequencyAsync(const float& frequency)
+    {
+      return setPeriodAsync(1000000.0f / frequency);
+    }
+    
+    // Advance setPeriodAsync() as far as the synchronization allows. true once the new period is running
+    bool pollPeriodAsync();
+    
+    // Latency distribution of the periodic callback since startup or resetLatencyStats(), see USING_LATENCY_PROBE.
+    // false if the probe isn't enabled or nothing was recorded yet
+    bool getLatencyStats(SAMDLatencyStats& stats);
+    
+    void resetLatencyStats();
+
+    // true while a buffered update has been written but not yet latched
+    bool isUpdatePending()
+    {
+      return TC3->COUNT16.STATUS.bit.CCBUFV0;
+    }
 
-    // interval (in microseconds) and duration (in milliseconds). Duration = 0 or not specified => run indefinitely
-    // No params and duration now. To be addes in the future by adding similar functions here or to SAMD-hal-timer.c
+    // Select an already running GCLK generator, and its frequency in Hz, as the timer clock. Call before attaching.
+    // With the Adafruit core, GCLK0 = F_CPU (120MHz), GCLK1 = 48MHz, GCLK2 = 100MHz, GCLK3 = 32.768kHz, GCLK4 = 12MHz.
+    // TC3 shares its peripheral clock channel with TC2
+    bool setClockSource(const uint8_t& generator, const uint32_t& generatorHz)
+    {
+      if ( (generator >= GCLK_GEN_NUM) || (generatorHz == 0) )
+        return false;
+        
+      _gclkGenerator  = generator;
+      _timerHz        = generatorHz;
+      
+      // Force the next attach to reprogram the clock
+      initialized     = false;
+      
+      return true;
+    }
+    
+    // Program GCLK generator 'generator' as clock 'source' (e.g. GCLK_GENCTRL_SRC_DPLL0_Val) divided by 'divider',
+    // then select it with setClockSource(). Don't reprogram generators used by the core (GCLK0-GCLK4)
+    bool configureClockGenerator(const uint8_t& generator, const uint8_t& source, const uint32_t& sourceHz, const uint16_t& divider);
+    
+    // Frequency (Hz) of the clock feeding the timer, before the prescaler
+    uint32_t getClockFrequency()
+    {
+      return _timerHz;
+    }
+    
+    // GCLK generator feeding the timer
+    uint8_t getClockGenerator()
+    {
+      return _gclkGenerator;
+    }
+
+    // Free-running compare-channel mode. The counter runs over its full range and each armed CCn channel has its
+    // own callback, fired 'offset' us after start and then every 'period' us, from a single handler.
+    // beginCompareChannels() selects the prescaler for the longest period or offset used (in us), and leaves the
+    // counter stopped at 0, so that channels attached before startCompareChannels() keep their exact phase relation.
+    // Channels attached while running are offset from the time of attachment.
+    bool beginCompareChannels(const float& maxPeriod);
+    bool attachCompareInterrupt(const uint8_t& channel, const float& offset, const float& period, timerCallback callback);
+    void detachCompareInterrupt(const uint8_t& channel);
+    void startCompareChannels();
+    
+    // Hardware one-shot. 'callback' runs once, 'delay' us from now, then the counter stops by itself (ONESHOT), so
+    // there is no later compare to race with. Calling it again with the same delay, or retriggerOneShot(), only
+    // issues a RETRIGGER command, which restarts the delay from 0 within a few clock cycles, even while it is running
+    bool fireOnceAfter(const float& delay, timerCallback callback);
+    
+    void retriggerOneShot()
+    {
+      while (TC3->COUNT16.SYNCBUSY.bit.CTRLB);
+      
+      TC3->COUNT16.CTRLBSET.reg = TC_CTRLBSET_CMD_RETRIGGER;
+    }
+    
+    // Run the timer at the given period (us) / frequency (Hz) with its CPU interrupt off, only as a trigger source
+    // for DMA (SAMDTimerDMA) or the Event System
+    bool setTriggerPeriod(const float& period);
+    
+    bool setTriggerFrequency(const float& frequency)
+    {
+      return setTriggerPeriod(1000000.0f / frequency);
+    }
+    
+    // DMAC trigger source (TRIGSRC) of the timer overflow
+    uint8_t getDMATriggerSource()
+    {
+      return TC3_DMAC_ID_OVF;
+    }
+    
+    // Enable the overflow event output, to be routed through EVSYS (SAMD_TimerEventSystem.hpp)
+    void enableEventOutput();
+    
+    // EVSYS generator (EVGEN) of the timer overflow
+    uint8_t getEventGenerator()
+    {
+      return EVSYS_ID_GEN_TC3_OVF;
+    }
+
+    // interval (in microseconds)
     bool setInterval(const unsigned long& interval, timerCallback callback)
     {
       return _setPeriod(interval, callback);
@@ -228,12 +589,62 @@ class SAMDTimerInterrupt
       return setFrequency(frequency, callback);
     }
 
-    // interval (in microseconds) and duration (in milliseconds). Duration = 0 or not specified => run indefinitely
-    // No params and duration now. To be addes in the future by adding similar functions here or to SAMD-hal-timer.c
+    // interval (in microseconds). See below for the param, duration and count variants
     bool attachInterruptInterval(const unsigned long& interval, timerCallback callback)
     {
       return _setPeriod(interval, callback);
     }
+    
+    // Same, with 'param' passed to each call. One driver class can then serve several timers with a single static
+    // function, e.g. callback = [](void* self) { ((Driver*) self)->onTimer(); }, param = this
+    bool attachInterruptInterval(const unsigned long& interval, timerCallback_p callback, void* param)
+    {
+      return _setPeriod(interval, setDispatch(callback, param));
+    }
+    
+    bool attachInterrupt(const float& frequency, timerCallback_p callback, void* param)
+    {
+      return setFrequency(frequency, setDispatch(callback, param));
+    }
+    
+    // Run 'callback' every 'interval' us for 'duration' ms only. The handler stops the timer after the last period,
+    // then calls 'doneCallback' (also in ISR context) if not NULL. Duration = 0 => run indefinitely
+    bool attachInterruptInterval(const unsigned long& interval, timerCallback callback, const unsigned long& duration,
+                                 timerCallback doneCallback = NULL)
+    {
+      uint32_t count = 0;
+      
+      if ( (duration != 0) && (interval != 0) )
+      {
+        // Nearest whole number of periods, at least one
+        count = ((uint64_t) duration * 1000 + interval / 2) / interval;
+        
+        if (count == 0)
+          count = 1;
+      }
+      
+      return attachInterruptIntervalCount(interval, callback, count, doneCallback);
+    }
+    
+    // Same, for exactly 'count' periods. Count = 0 => run indefinitely. Restart with a new attach once done
+    bool attachInterruptIntervalCount(const unsigned long& interval, timerCallback callback, const uint32_t& count,
+                                      timerCallback doneCallback = NULL)
+    {
+      _runLimit     = count;
+      _doneCallback = doneCallback;
+      
+      return _setPeriod(interval, callback);
+    }
+    
+    // Periods left before the timer stops, 0 => no run limit, or already stopped
+    uint32_t getRemainingRuns();
+    
+    // Period (us) the timer really runs at, from the programmed CC0 / PER (average of the exact or trimmed mode),
+    // the prescaler and the clock corrected by SAMD_clockErrorPpb. Can differ from the requested one by CC truncation
+    double getPeriod();
+    
+    // Longest period (us) a periodic attach can program, at the largest prescaler
+    double getMaxPeriod();
 
     void detachInterrupt()
     {
@@ -260,10 +671,30 @@ class SAMDTimerInterrupt
       // Disable Interrupt
       if (_timerNumber == TIMER_TC3)
       {
-        NVIC_EnableIRQ(TC3_IRQn); 
+        enableIRQ();
       }
     }
 
+    // NVIC priority of the timer interrupt, 0 (highest) to SAMD_NVIC_PRIORITY_LEVELS - 1. A timer with a higher
+    // priority than USB, SERCOM, etc. preempts their handlers. Applied at once, and kept across detachInterrupt() /
+    // reattachInterrupt() and new attaches
+    bool setInterruptPriority(const uint8_t& priority)
+    {
+      if (priority >= SAMD_NVIC_PRIORITY_LEVELS)
+        return false;
+        
+      _priority = priority;
+      
+      NVIC_SetPriority(TC3_IRQn, priority);
+      
+      return true;
+    }
+    
+    uint8_t getInterruptPriority()
+    {
+      return NVIC_GetPriority(TC3_IRQn);
+    }
+
     // Duration (in milliseconds). Duration = 0 or not specified => run indefinitely
     void enableTimer()
     {     
@@ -275,96 +706,79 @@ class SAMDTimerInterrupt
       }
     }
 
-    // Just stop clock source, clear the count
+    // Stop the counter with the STOP command. The timer keeps its configuration, so restartTimer() needs no new attach
     void stopTimer()
     {
-      // TODO, clear the count
-      disableTimer();
+      while (TC3->COUNT16.SYNCBUSY.bit.CTRLB);
+      
+      TC3->COUNT16.CTRLBSET.reg = TC_CTRLBSET_CMD_STOP;
     }
 
-    // Just reconnect clock source, start current count from 0
+    // Start a full period from count 0 with the RETRIGGER command, within a few clock cycles. A match left pending
+    // by stopTimer() is dropped, so the first period is never short
     void restartTimer()
     {
-      // TODO, clear the count
-      enableTimer();
+      TC3->COUNT16.INTFLAG.reg = TC_INTFLAG_MASK;
+      NVIC_ClearPendingIRQ(TC3_IRQn);
+      
+      if (!TC3->COUNT16.CTRLA.bit.ENABLE)
+      {
+        // Stopped by disableTimer(), commands are ignored until enabled
+        TC3->COUNT16.COUNT.reg = 0;
+        TC3_wait_for_sync();
+        
+        enableTimer();
+        
+        return;
+      }
+      
+      while (TC3->COUNT16.SYNCBUSY.bit.CTRLB);
+      
+      TC3->COUNT16.CTRLBSET.reg = TC_CTRLBSET_CMD_RETRIGGER;
     }
     
     private:
     
+    uint16_t readCount()
+    {
+      TC3->COUNT16.CTRLBSET.reg = TC_CTRLBSET_CMD_READSYNC;
+      
+      while (TC3->COUNT16.SYNCBUSY.bit.CTRLB);
+      while (TC3->COUNT16.CTRLBSET.bit.CMD != 0);
+      
+      return TC3->COUNT16.COUNT.reg;
+    }
+    
     void setPeriod_TIMER_TC3(const float& period)
     {
-      uint32_t TC_CTRLA_PRESCALER_DIVN = 1;
-
-      TC3->COUNT16.CTRLA.reg &= ~TC_CTRLA_ENABLE;
-      TC3_wait_for_sync();
-      TC3->COUNT16.CTRLA.reg &= ~TC_CTRLA_PRESCALER_DIV1024;
-      TC3_wait_for_sync();
-      TC3->COUNT16.CTRLA.reg &= ~TC_CTRLA_PRESCALER_DIV256;
-      TC3_wait_for_sync();
-      TC3->COUNT16.CTRLA.reg &= ~TC_CTRLA_PRESCALER_DIV64;
-      TC3_wait_for_sync();
-      TC3->COUNT16.CTRLA.reg &= ~TC_CTRLA_PRESCALER_DIV16;
-      TC3_wait_for_sync();
-      TC3->COUNT16.CTRLA.reg &= ~TC_CTRLA_PRESCALER_DIV4;
-      TC3_wait_for_sync();
-      TC3->COUNT16.CTRLA.reg &= ~TC_CTRLA_PRESCALER_DIV2;
-      TC3_wait_for_sync();
-      TC3->COUNT16.CTRLA.reg &= ~TC_CTRLA_PRESCALER_DIV1;
-      TC3_wait_for_sync();
+      // The prescaler thresholds are in us for a TIMER_HZ clock. Scale the period so the same tick ranges are used
+      uint8_t  prescalerIndex = SAMD_periodPrescalerIndex(period * ((float) _timerHz / TIMER_HZ));
+      uint32_t prescalerBits  = TC_CTRLA_PRESCALER(prescalerIndex);
+      
+      _prescaler = SAMD_prescalerDivider[prescalerIndex];
 
-      if (period > 300000) 
-      {
-        TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV1024;
-        _prescaler = 1024;
-      } 
-      else if (80000 < period && period <= 300000) 
-      {
-        TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV256;
-        _prescaler = 256;
-      } 
-      else if (20000 < period && period <= 80000) 
-      {
-        TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV64;
-        _prescaler = 64;
-      } 
-      else if (10000 < period && period <= 20000) 
-      {
-        TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV16;
-        _prescaler = 16;
-      } 
-      else if (5000 < period && period <= 10000) 
-      {
-        TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV8;
-        _prescaler = 8;
-      } 
-      else if (2500 < period && period <= 5000) 
-      {
-        TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV4;
-        _prescaler = 4;
-      } 
-      else if (1000 < period && period <= 2500) {
-        TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV2;
-        _prescaler = 2;
-      } 
-      else if (period <= 1000) 
+      uint16_t _compareValue = (uint16_t)(clockHz() / (_prescaler/(period / 1000000.0))) - 1;
+      
+      uint32_t ctrla = TC3->COUNT16.CTRLA.reg;
+      
+      // CTRLA is enable-protected. Only stop the counter when the prescaler really changes, with a single write
+      // for the new prescaler instead of clearing each bit separately
+      if ( !(ctrla & TC_CTRLA_ENABLE) || ((ctrla & TC_CTRLA_PRESCALER_Msk) != prescalerBits) )
       {
-        TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV1;
-        _prescaler = 1;
+        TC3->COUNT16.CTRLA.reg = ctrla & ~TC_CTRLA_ENABLE;
+        while (TC3->COUNT16.SYNCBUSY.bit.ENABLE);
+        
+        TC3->COUNT16.CTRLA.reg = (ctrla & ~(TC_CTRLA_ENABLE | TC_CTRLA_PRESCALER_Msk)) | prescalerBits;
       }
-      
-      TC3->COUNT16.CTRLA.reg |= TC_CTRLA_PRESCALER_DIVN;
-      TC3_wait_for_sync();
-
-      uint16_t _compareValue = (uint16_t)(TIMER_HZ / (_prescaler/(period / 1000000.0))) - 1;
 
       // Make sure the count is in a proportional position to where it was
       // to prevent any jitter or disconnect when changing the compare value.
       TC3->COUNT16.COUNT.reg = map(TC3->COUNT16.COUNT.reg, 0,
                                    TC3->COUNT16.CC[0].reg, 0, _compareValue);
       TC3->COUNT16.CC[0].reg = _compareValue;
-      TC3_wait_for_sync();
 
-      TC3->COUNT16.CTRLA.bit.ENABLE = 1;
+      // COUNT, CC0 and ENABLE synchronize together, one wait for all of them
+      TC3->COUNT16.CTRLA.reg |= TC_CTRLA_ENABLE;
       TC3_wait_for_sync();
       
       TISR_LOGDEBUG3(F("SAMD51 TC3 period ="), period, F(", _prescaler ="), _prescaler);
@@ -389,10 +803,15 @@ class SAMDTimerInterrupt;
 typedef SAMDTimerInterrupt SAMDTimer;
 
 typedef void (*timerCallback)  ();
+typedef void (*timerCallback_p)(void*);
 
 #define SAMD_TC3        ((TcCount16*) _SAMDTimer)
 #define SAMD_TCC        ((Tcc*) _SAMDTimer)
 
+// Compare channels usable by beginCompareChannels()
+#define SAMD_TC3_NUM_CHANNELS     2
+#define SAMD_TCC_NUM_CHANNELS     4
+
 class SAMDTimerInterrupt
 {
   private:
@@ -407,10 +826,62 @@ class SAMDTimerInterrupt
     int             _prescaler;
     int             _compareValue;
     bool initialized;
+    
+    float           _frequencyError;  // residual error (Hz) of the last setFrequencyExact()
+    
+    uint8_t         _gclkGenerator;   // GCLK generator feeding the timer, GCLK0 (48MHz) by default
+    uint32_t        _timerHz;         // frequency of that generator, used by all period math
+    
+    bool            _compareChannels; // true after beginCompareChannels(), until the next periodic attach
+    
+    float           _oneShotDelay;    // delay (us) of the armed fireOnceAfter(), 0 => periodic mode
+    
+    float           _lastPeriod;      // period (us) of the last periodic attach, 0 => CC / PER changed since
+    int32_t         _lastClockError;  // SAMD_clockErrorPpb used by that attach
+    double          _trimPeriod;      // period (us) applyClockError() keeps on the corrected clock, 0 => none
+    
+    SAMDAsyncState  _asyncState;      // setPeriodAsync() progress
+    uint8_t         _asyncPrescaler;
+    uint32_t        _asyncCompare;
+    
+    uint8_t         _priority;        // NVIC priority, SAMD_NVIC_PRIORITY_UNSET => left as is
+    
+    uint32_t        _runLimit;        // periods to run for the next attach only, 0 => indefinitely
+    timerCallback   _doneCallback;    // called by the handler once _runLimit periods have run
+    
+    // Set the periodic callback, and arm the run limit of attachInterruptIntervalCount() if any
+    void setCallback(timerCallback callback);
+    
+    // _timerHz corrected by SAMD_clockErrorPpb, for all tick counts
+    double clockHz()
+    {
+      return _timerHz * (1.0 + SAMD_clockErrorPpb * 1e-9);
+    }
+    
+    IRQn_Type getIRQ()
+    {
+      return (_timerNumber == TIMER_TC3) ? TC3_IRQn : TCC0_IRQn;
+    }
+    
+    // Store callback / param in the dispatch table entry of this timer, and return the dispatcher to attach
+    timerCallback setDispatch(timerCallback_p callback, void* param);
+    
+    // Every attach / reattach path enables the IRQ through here, so the priority survives detachInterrupt()
+    void enableIRQ()
+    {
+      if (_priority != SAMD_NVIC_PRIORITY_UNSET)
+        NVIC_SetPriority(getIRQ(), _priority);
+        
+      NVIC_EnableIRQ(getIRQ());
+    }
 
   public:
 
-    SAMDTimerInterrupt(const SAMDTimerNumber& timerNumber) : initialized(false), _prescaler(0)
+    SAMDTimerInterrupt(const SAMDTimerNumber& timerNumber) : initialized(false), _prescaler(0), _frequencyError(0),
+      _gclkGenerator(0), _timerHz(TIMER_HZ), _compareChannels(false),
+      _oneShotDelay(0), _lastPeriod(0), _lastClockError(0), _trimPeriod(0),
+      _asyncState(SAMD_ASYNC_IDLE), _priority(SAMD_NVIC_PRIORITY_UNSET),
+      _runLimit(0), _doneCallback(NULL)
     {
       _timerNumber = timerNumber;
            
@@ -426,15 +897,144 @@ class SAMDTimerInterrupt
       _callback = NULL;      
     };
     
-    ~SAMDTimerInterrupt()
-    {
-    }
+    ~SAMDTimerInterrupt();
    
     bool setFrequency(const float& frequency, timerCallback callback);
     bool _setPeriod(const float& _period, timerCallback callback);
+    
+    // Fractional-period mode. The ISR runs a 32-bit phase accumulator and alternates CC (TC3) or PER (TCC) between
+    // N and N+1 ticks, so the long-term average frequency is exact, with at most one timer tick of jitter per period
+    bool setFrequencyExact(const float& frequency, timerCallback callback);
+    
+    // Retune the running periodic timer to SAMD_clockErrorPpb through the buffered CC / PER, with the sub-tick part in
+    // the phase accumulator. Called by SAMD_setClockError() for the last timer attached on each TC / TCC
+    bool applyClockError();
+
+    // Residual error (in Hz, achieved - requested) of the average frequency set by the last setFrequencyExact()
+    float getFrequencyError()
+    {
+      return _frequencyError;
+    }
+
+    // Glitch-free retuning of a running timer. TCC only writes PERB, which the hardware latches at the next overflow.
+    // TC3 has no buffer register on SAMD21, so the ISR applies the new CC at the next compare match instead.
+    // The prescaler is kept, so the new period must fit in it
+    bool setPeriodBuffered(const float& period);
+    
+    bool setFrequencyBuffered(const float& frequency)
+    {
+      return setPeriodBuffered(1000000.0f / frequency);
+    }
+    
+    // Non-blocking retune of an attached periodic timer. Returns at once without waiting for any register
+    // synchronization; call pollPeriodAsync(), e.g. from loop(), until it returns true. With an unchanged prescaler
+    // the new period goes through the buffer and is already complete. A prescaler change restarts the period from 0
+    bool setPeriodAsync(const float& period);
+    
+    bool setFrequencyAsync(const float& frequency)
+    {
+      return setPeriodAsync(1000000.0f / frequency);
+    }
+    
+    // Advance setPeriodAsync() as far as the synchronization allows. true once the new period is running
+    bool pollPeriodAsync();
+    
+    // Latency distribution of the periodic callback since startup or resetLatencyStats(), see USING_LATENCY_PROBE.
+    // false if the probe isn't enabled or nothing was recorded yet
+    bool getLatencyStats(SAMDLatencyStats& stats);
+    
+    void resetLatencyStats();
+
+    // true while a buffered update has been written but not yet latched
+    bool isUpdatePending();
+
+    // Select an already running GCLK generator, and its frequency in Hz, as the timer clock. Call before attaching.
+    // With the Arduino core, GCLK0 = 48MHz, GCLK1 = 32.768kHz and GCLK3 = 8MHz.
+    // TC3 shares its clock with TCC2, and TCC0 with TCC1
+    bool setClockSource(const uint8_t& generator, const uint32_t& generatorHz)
+    {
+      if ( (generator >= GCLK_GEN_NUM) || (generatorHz == 0) )
+        return false;
+        
+      _gclkGenerator  = generator;
+      _timerHz        = generatorHz;
+      
+      // Force the next attach to reprogram the clock
+      initialized     = false;
+      
+      return true;
+    }
+    
+    // Program GCLK generator 'generator' as clock 'source' (e.g. GCLK_GENCTRL_SRC_XOSC32K_Val) divided by 'divider',
+    // then select it with setClockSource(). Don't reprogram generators used by the core (GCLK0-GCLK3)
+    bool configureClockGenerator(const uint8_t& generator, const uint8_t& source, const uint32_t& sourceHz, const uint16_t& divider);
+    
+    // Frequency (Hz) of the clock feeding the timer, before the prescaler
+    uint32_t getClockFrequency()
+    {
+      return _timerHz;
+    }
+    
+    // GCLK generator feeding the timer
+    uint8_t getClockGenerator()
+    {
+      return _gclkGenerator;
+    }
+
+    // Free-running compare-channel mode. The counter runs over its full range and each armed CCn channel has its
+    // own callback, fired 'offset' us after start and then every 'period' us, from a single handler.
+    // beginCompareChannels() selects the prescaler for the longest period or offset used (in us), and leaves the
+    // counter stopped at 0, so that channels attached before startCompareChannels() keep their exact phase relation.
+    // Channels attached while running are offset from the time of attachment.
+    bool beginCompareChannels(const float& maxPeriod);
+    bool attachCompareInterrupt(const uint8_t& channel, const float& offset, const float& period, timerCallback callback);
+    void detachCompareInterrupt(const uint8_t& channel);
+    void startCompareChannels();
+    
+    // Hardware one-shot. 'callback' runs once, 'delay' us from now, then the counter stops by itself (ONESHOT), so
+    // there is no later compare to race with. Calling it again with the same delay, or retriggerOneShot(), only
+    // issues a RETRIGGER command, which restarts the delay from 0 within a few clock cycles, even while it is running
+    bool fireOnceAfter(const float& delay, timerCallback callback);
+    
+    void retriggerOneShot()
+    {
+      if (_timerNumber == TIMER_TC3)
+      {
+        SAMD_TC3->CTRLBSET.reg = TC_CTRLBSET_CMD_RETRIGGER;
+      }
+      else if (_timerNumber == TIMER_TCC)
+      {
+        while (SAMD_TCC->SYNCBUSY.bit.CTRLB);
+        
+        SAMD_TCC->CTRLBSET.reg = TCC_CTRLBSET_CMD_RETRIGGER;
+      }
+    }
+    
+    // Run the timer at the given period (us) / frequency (Hz) with its CPU interrupt off, only as a trigger source
+    // for DMA (SAMDTimerDMA) or the Event System
+    bool setTriggerPeriod(const float& period);
+    
+    bool setTriggerFrequency(const float& frequency)
+    {
+      return setTriggerPeriod(1000000.0f / frequency);
+    }
+    
+    // DMAC trigger source (TRIGSRC) of the timer overflow
+    uint8_t getDMATriggerSource()
+    {
+      return (_timerNumber == TIMER_TC3) ? TC3_DMAC_ID_OVF : TCC0_DMAC_ID_OVF;
+    }
+    
+    // Enable the overflow event output, to be routed through EVSYS (SAMD_TimerEventSystem.hpp)
+    void enableEventOutput();
+    
+    // EVSYS generator (EVGEN) of the timer overflow
+    uint8_t getEventGenerator()
+    {
+      return (_timerNumber == TIMER_TC3) ? EVSYS_ID_GEN_TC3_OVF : EVSYS_ID_GEN_TCC0_OVF;
+    }
 
-    // interval (in microseconds) and duration (in milliseconds). Duration = 0 or not specified => run indefinitely
-    // No params and duration now. To be addes in the future by adding similar functions here or to SAMD-hal-timer.c
+    // interval (in microseconds)
     bool setInterval(const unsigned long& interval, timerCallback callback)
     {
       return _setPeriod(interval, callback);
@@ -445,12 +1045,62 @@ class SAMDTimerInterrupt
       return setFrequency(frequency, callback);
     }
 
-    // interval (in microseconds) and duration (in milliseconds). Duration = 0 or not specified => run indefinitely
-    // No params and duration now. To be addes in the future by adding similar functions here or to SAMD-hal-timer.c
+    // interval (in microseconds). See below for the param, duration and count variants
     bool attachInterruptInterval(const unsigned long& interval, timerCallback callback)
     {
       return _setPeriod(interval, callback);
     }
+    
+    // Same, with 'param' passed to each call. One driver class can then serve several timers with a single static
+    // function, e.g. callback = [](void* self) { ((Driver*) self)->onTimer(); }, param = this
+    bool attachInterruptInterval(const unsigned long& interval, timerCallback_p callback, void* param)
+    {
+      return _setPeriod(interval, setDispatch(callback, param));
+    }
+    
+    bool attachInterrupt(const float& frequency, timerCallback_p callback, void* param)
+    {
+      return setFrequency(frequency, setDispatch(callback, param));
+    }
+    
+    // Run 'callback' every 'interval' us for 'duration' ms only. The handler stops the timer after the last period,
+    // then calls 'doneCallback' (also in ISR context) if not NULL. Duration = 0 => run indefinitely
+    bool attachInterruptInterval(const unsigned long& interval, timerCallback callback, const unsigned long& duration,
+                                 timerCallback doneCallback = NULL)
+    {
+      uint32_t count = 0;
+      
+      if ( (duration != 0) && (interval != 0) )
+      {
+        // Nearest whole number of periods, at least one
+        count = ((uint64_t) duration * 1000 + interval / 2) / interval;
+        
+        if (count == 0)
+          count = 1;
+      }
+      
+      return attachInterruptIntervalCount(interval, callback, count, doneCallback);
+    }
+    
+    // Same, for exactly 'count' periods. Count = 0 => run indefinitely. Restart with a new attach once done
+    bool attachInterruptIntervalCount(const unsigned long& interval, timerCallback callback, const uint32_t& count,
+                                      timerCallback doneCallback = NULL)
+    {
+      _runLimit     = count;
+      _doneCallback = doneCallback;
+      
+      return _setPeriod(interval, callback);
+    }
+    
+    // Periods left before the timer stops, 0 => no run limit, or already stopped
+    uint32_t getRemainingRuns();
+    
+    // Period (us) the timer really runs at, from the programmed CC0 / PER (average of the exact or trimmed mode),
+    // the prescaler and the clock corrected by SAMD_clockErrorPpb. Can differ from the requested one by CC truncation
+    double getPeriod();
+    
+    // Longest period (us) a periodic attach can program, at the largest prescaler
+    double getMaxPeriod();
 
     void detachInterrupt()
     {
@@ -485,16 +1135,32 @@ class SAMDTimerInterrupt
     void reattachInterrupt()
     {
       // Disable Interrupt
-      if (_timerNumber == TIMER_TC3)
+      if ( (_timerNumber == TIMER_TC3) || (_timerNumber == TIMER_TCC) )
       {
-        NVIC_EnableIRQ(TC3_IRQn); 
-      }
-      else if (_timerNumber == TIMER_TCC)
-      {
-        NVIC_EnableIRQ(TCC0_IRQn);     
+        enableIRQ();
       }
     }
 
+    // NVIC priority of the timer interrupt, 0 (highest) to SAMD_NVIC_PRIORITY_LEVELS - 1. A timer with a higher
+    // priority than USB, SERCOM, etc. preempts their handlers. Applied at once, and kept across detachInterrupt() /
+    // reattachInterrupt() and new attaches
+    bool setInterruptPriority(const uint8_t& priority)
+    {
+      if (priority >= SAMD_NVIC_PRIORITY_LEVELS)
+        return false;
+        
+      _priority = priority;
+      
+      NVIC_SetPriority(getIRQ(), priority);
+      
+      return true;
+    }
+    
+    uint8_t getInterruptPriority()
+    {
+      return NVIC_GetPriority(getIRQ());
+    }
+
     // Duration (in milliseconds). Duration = 0 or not specified => run indefinitely
     void enableTimer()
     {     
@@ -512,21 +1178,86 @@ class SAMDTimerInterrupt
       }
     }
 
-    // Just stop clock source, clear the count
+    // Stop the counter with the STOP command. The timer keeps its configuration, so restartTimer() needs no new attach
     void stopTimer()
     {
-      // TODO, clear the count
-      disableTimer();
+      if (_timerNumber == TIMER_TC3)
+      {
+        SAMD_TC3->CTRLBSET.reg = TC_CTRLBSET_CMD_STOP;
+        while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+      }
+      else if (_timerNumber == TIMER_TCC)
+      {
+        while (SAMD_TCC->SYNCBUSY.bit.CTRLB);
+        
+        SAMD_TCC->CTRLBSET.reg = TCC_CTRLBSET_CMD_STOP;
+      }
     }
 
-    // Just reconnect clock source, start current count from 0
+    // Start a full period from count 0 with the RETRIGGER command, within a few clock cycles. A match left pending
+    // by stopTimer() is dropped, so the first period is never short
     void restartTimer()
     {
-      // TODO, clear the count
-      enableTimer();
+      if (_timerNumber == TIMER_TC3)
+      {
+        SAMD_TC3->INTFLAG.reg = TC_INTFLAG_MASK;
+        NVIC_ClearPendingIRQ(TC3_IRQn);
+        
+        if (!SAMD_TC3->CTRLA.bit.ENABLE)
+        {
+          // Stopped by disableTimer(), commands are ignored until enabled
+          SAMD_TC3->COUNT.reg = 0;
+          while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+          
+          enableTimer();
+          
+          return;
+        }
+        
+        SAMD_TC3->CTRLBSET.reg = TC_CTRLBSET_CMD_RETRIGGER;
+      }
+      else if (_timerNumber == TIMER_TCC)
+      {
+        SAMD_TCC->INTFLAG.reg = TCC_INTFLAG_MASK;
+        NVIC_ClearPendingIRQ(TCC0_IRQn);
+        
+        if (!SAMD_TCC->CTRLA.bit.ENABLE)
+        {
+          SAMD_TCC->COUNT.reg = 0;
+          while (SAMD_TCC->SYNCBUSY.bit.COUNT);
+          
+          enableTimer();
+          
+          return;
+        }
+        
+        while (SAMD_TCC->SYNCBUSY.bit.CTRLB);
+        
+        SAMD_TCC->CTRLBSET.reg = TCC_CTRLBSET_CMD_RETRIGGER;
+      }
     }
     
     private:
+    
+    uint32_t readCount()
+    {
+      if (_timerNumber == TIMER_TC3)
+      {
+        SAMD_TC3->READREQ.reg = TC_READREQ_RREQ | TC_READREQ_ADDR(0x10); // 0x10 is the offset of the 16-bit count register
+        while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+        
+        return SAMD_TC3->COUNT.reg;
+      }
+      else
+      {
+        SAMD_TCC->CTRLBSET.reg = TCC_CTRLBSET_CMD_READSYNC;
+        while (SAMD_TCC->SYNCBUSY.bit.CTRLB);
+        while (SAMD_TCC->SYNCBUSY.bit.COUNT);
+        
+        return SAMD_TCC->COUNT.reg;
+      }
+    }
+    
     inline byte getPrescalerBitShift(uint16_t ctrla)
     {
       // prescaler is stored in bits 8 thru 11 of ctrla, so we need to shift 8 bits right and mask off lower 4 bits
@@ -552,6 +1283,9 @@ class SAMDTimerInterrupt
     void setPeriod_TIMER_TC3(const float& period)
     {
       uint32_t TC_CTRLA_PRESCALER_DIVN = 1;
+      
+      // The prescaler thresholds are in us for a TIMER_HZ clock. Scale the period so the same tick ranges are used
+      float scaledPeriod = period * ((float) _timerHz / TIMER_HZ);
 
       TcCount16* _Timer = (TcCount16*) TC3;
       uint16_t ctrla = _Timer->CTRLA.reg;
@@ -561,59 +1295,61 @@ class SAMDTimerInterrupt
       byte old_prescaler = getPrescalerBitShift(ctrla);
       byte new_prescaler = 0;
 
-      if (period > 300000) 
+      if (scaledPeriod > 300000) 
       {
         // Set prescaler to 1024
         TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV1024;
         new_prescaler = 10;
       } 
-      else if (80000 < period && period <= 300000) 
+      else if (80000 < scaledPeriod && scaledPeriod <= 300000) 
       {
         // Set prescaler to 256
         TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV256;
         new_prescaler = 8;
       } 
-      else if (20000 < period && period <= 80000) 
+      else if (20000 < scaledPeriod && scaledPeriod <= 80000) 
       {
         // Set prescaler to 64
         TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV64;
         new_prescaler = 6;
       } 
-      else if (10000 < period && period <= 20000) 
+      else if (10000 < scaledPeriod && scaledPeriod <= 20000) 
       {
         // Set prescaler to 16
         TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV16;
         new_prescaler = 4;
       } 
-      else if (5000 < period && period <= 10000) 
+      else if (5000 < scaledPeriod && scaledPeriod <= 10000) 
       {
         // Set prescaler to 8
         TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV8;
         new_prescaler = 3;
       } 
-      else if (2500 < period && period <= 5000) 
+      else if (2500 < scaledPeriod && scaledPeriod <= 5000) 
       {
         // Set prescaler to 4
         TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV4;
         new_prescaler = 2;
       } 
-      else if (1000 < period && period <= 2500) 
+      else if (1000 < scaledPeriod && scaledPeriod <= 2500) 
       {
         // Set prescaler to 2
         TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV2;
         new_prescaler = 1;
       } 
-      else // if (period <= 1000) 
+      else // if (scaledPeriod <= 1000) 
       {
         // Set prescaler to 1
         TC_CTRLA_PRESCALER_DIVN = TC_CTRLA_PRESCALER_DIV1;
         new_prescaler = 0;
       }
 
+      _prescaler = (1 << new_prescaler);
+
       // mask out old prescaler value, and set the new prescaler value
       ctrla = (ctrla & 0xf0ff) | TC_CTRLA_PRESCALER_DIVN;
 
-      uint16_t _compareValue = (uint16_t)(TIMER_HZ / ((1<<new_prescaler) / (period / 1000000.0))) - 1;
+      uint16_t _compareValue = (uint16_t)(clockHz() / ((1<<new_prescaler) / (period / 1000000.0))) - 1;
 
       if (new_prescaler != old_prescaler && was_enabled)
       {
@@ -653,11 +1389,16 @@ class SAMDTimerInterrupt
         while (_Timer->STATUS.bit.SYNCBUSY);
       }
 
-      // in all cases, we need to set the (new) CC, and set the (new) prescaler and (re)enable the timer
+      // in all cases, we need to set the (new) CC
       _Timer->CC[0].reg = _compareValue;
-      while (_Timer->STATUS.bit.SYNCBUSY);
 
-      _Timer->CTRLA.reg = ctrla | TC_CTRLA_ENABLE;
+      // CTRLA only needs the (new) prescaler and ENABLE when one of them changes. A write during synchronization
+      // stalls the bus until the previous one completes, so a single wait covers both
+      if ( (new_prescaler != old_prescaler) || !was_enabled )
+      {
+        _Timer->CTRLA.reg = ctrla | TC_CTRLA_ENABLE;
+      }
+      
       while (_Timer->STATUS.bit.SYNCBUSY);
       
       TISR_LOGDEBUG3(F("SAMD21 TC3 period ="), period, F(", _prescaler ="), _prescaler);
@@ -668,77 +1409,32 @@ class SAMDTimerInterrupt
     {
       Tcc* _Timer = (Tcc*) _SAMDTimer;
       
-      _Timer->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
-      while (_Timer->SYNCBUSY.bit.ENABLE == 1);
-      _Timer->CTRLA.reg &= ~TCC_CTRLA_PRESCALER_DIV1024;
-      while (_Timer->SYNCBUSY.bit.ENABLE == 1);
-      _Timer->CTRLA.reg &= ~TCC_CTRLA_PRESCALER_DIV256;
-      while (_Timer->SYNCBUSY.bit.ENABLE == 1);
-      _Timer->CTRLA.reg &= ~TCC_CTRLA_PRESCALER_DIV64;
-      while (_Timer->SYNCBUSY.bit.ENABLE == 1);
-      _Timer->CTRLA.reg &= ~TCC_CTRLA_PRESCALER_DIV16;
-      while (_Timer->SYNCBUSY.bit.ENABLE == 1);
-      _Timer->CTRLA.reg &= ~TCC_CTRLA_PRESCALER_DIV4;
-      while (_Timer->SYNCBUSY.bit.ENABLE == 1);
-      _Timer->CTRLA.reg &= ~TCC_CTRLA_PRESCALER_DIV2;
-      while (_Timer->SYNCBUSY.bit.ENABLE == 1);
-      _Timer->CTRLA.reg &= ~TCC_CTRLA_PRESCALER_DIV1;
-      while (_Timer->SYNCBUSY.bit.ENABLE == 1);
-      
-	    if (period > 300000) 
-	    {
-		    // Set prescaler to 1024
-		    _Timer->CTRLA.reg |= TCC_CTRLA_PRESCALER_DIV1024;
-		    _prescaler = 1024;
-	    } 
-	    else if (80000 < period && period <= 300000) 
-	    {
-		    // Set prescaler to 256
-		    _Timer->CTRLA.reg |= TCC_CTRLA_PRESCALER_DIV256;
-		    _prescaler = 256;
-	    } 
-	    else if (20000 < period && period <= 80000) 
-	    {
-		    // Set prescaler to 64
-		    _Timer->CTRLA.reg |= TCC_CTRLA_PRESCALER_DIV64;
-		    _prescaler = 64;
-	    } 
-	    else if (10000 < period && period <= 20000) 
-	    {
-		    // Set prescaler to 16
-		    _Timer->CTRLA.reg |= TCC_CTRLA_PRESCALER_DIV16;
-		    _prescaler = 16;
-	    } 
-	    else if (5000 < period && period <= 10000) 
-	    {
-		    // Set prescaler to 8
-		    _Timer->CTRLA.reg |= TCC_CTRLA_PRESCALER_DIV8;
-		    _prescaler = 8;
-	    } 
-	    else if (2500 < period && period <= 5000) 
-	    {
-		    // Set prescaler to 4
-		    _Timer->CTRLA.reg |= TCC_CTRLA_PRESCALER_DIV4;
-		    _prescaler = 4;
-	    } 
-	    else if (1000 < period && period <= 2500) 
-	    {
-		    // Set prescaler to 2
-		    _Timer->CTRLA.reg |= TCC_CTRLA_PRESCALER_DIV2;
-		    _prescaler = 2;
-	    } 
-	    else if (period <= 1000) 
-	    {
-		    // Set prescaler to 1
-		    _Timer->CTRLA.reg |= TCC_CTRLA_PRESCALER_DIV1;
-		    _prescaler = 1;
-	    }
+      // The prescaler thresholds are in us for a TIMER_HZ clock. Scale the period so the same tick ranges are used
+      uint8_t  prescalerIndex = SAMD_periodPrescalerIndex(period * ((float) _timerHz / TIMER_HZ));
+      uint32_t prescalerBits  = TCC_CTRLA_PRESCALER(prescalerIndex);
+      uint32_t ctrla          = _Timer->CTRLA.reg;
+      bool     restart        = false;
+      
+      _prescaler = SAMD_prescalerDivider[prescalerIndex];
+      
+      // CTRLA is enable-protected. Only stop the counter when the prescaler really changes, with a single write
+      // for the new prescaler instead of clearing each bit separately
+      if ( (ctrla & TCC_CTRLA_PRESCALER_Msk) != prescalerBits )
+      {
+        if (ctrla & TCC_CTRLA_ENABLE)
+        {
+          _Timer->CTRLA.reg = ctrla & ~TCC_CTRLA_ENABLE;
+          while (_Timer->SYNCBUSY.bit.ENABLE == 1);
+          
+          restart = true;
+        }
+        
+        _Timer->CTRLA.reg = (ctrla & ~(TCC_CTRLA_ENABLE | TCC_CTRLA_PRESCALER_Msk)) | prescalerBits;
+      }
 	    
-	    _compareValue = (int)(TIMER_HZ / (_prescaler / (period / 1000000))) - 1;
+	    _compareValue = (int)(clockHz() / (_prescaler / (period / 1000000))) - 1;
 
 	    _Timer->PER.reg = _compareValue; 
-	    
-      while (_Timer->SYNCBUSY.bit.PER == 1);
 
       // Make sure the count is in a proportional position to where it was
       // to prevent any jitter or disconnect when changing the compare value.
@@ -747,7 +1443,11 @@ class SAMDTimerInterrupt
       _Timer->CC[0].reg = 0xFFF;
 	    //_Timer->CC[0].reg = _compareValue;
 	    
-      while (_Timer->SYNCBUSY.bit.CC0 == 1);
+      if (restart)
+        _Timer->CTRLA.reg |= TCC_CTRLA_ENABLE;
+      
+      // PER, CC0 and ENABLE synchronize in parallel, one wait for all of them
+      while (_Timer->SYNCBUSY.reg != 0);
       
       TISR_LOGDEBUG3(F("SAMD21 TCC period ="), period, F(", _prescaler ="), _prescaler);
       TISR_LOGDEBUG1(F("_compareValue ="), _compareValue);
@@ -756,4 +1456,45 @@ class SAMDTimerInterrupt
 
 #endif    // #if (TIMER_INTERRUPT_USING_SAMD51)
 
+////////////////////////////////////////////////////
+
+// Compile-time bound handler. The callback is a template argument, so it is inlined into the vector instead of being
+// called through TC3_callback / TCC_callback. Configure the timer as usual, e.g. with attachInterruptInterval(), then
+// define USING_TC3_STATIC_HANDLER (USING_TCC_STATIC_HANDLER for SAMD21 TCC) before including "SAMDTimerInterrupt.h"
+// and put SAMD_TIMER_ISR_TC3(callback) (SAMD_TIMER_ISR_TCC(callback)) at file scope.
+// Only the plain periodic mode is served. setFrequencyExact(), setPeriodBuffered() on SAMD21 TC3 and the
+// compare-channel mode and the run limits of attachInterruptIntervalCount() rely on the library handler.
+template<SAMDTimerNumber TIMER, timerCallback Callback>
+class SAMDTimerStatic
+{
+  public:
+    static inline __attribute__((always_inline)) void handleInterrupt()
+    {
+#if (TIMER_INTERRUPT_USING_SAMD21)
+      if (TIMER == TIMER_TCC)
+      {
+        // CC0 match is enabled as well, but only the overflow ends a period
+        uint32_t flags = TCC0->INTFLAG.reg;
+        
+        TCC0->INTFLAG.reg = flags;
+        
+        if (flags & TCC_INTFLAG_OVF)
+          Callback();
+          
+        return;
+      }
+#endif
+
+      TC3->COUNT16.INTFLAG.reg = TC_INTFLAG_MC0;
+      
+      Callback();
+    }
+};
+
+#define SAMD_TIMER_ISR_TC3(callback)      SAMD_TIMER_RAMFUNC void TC3_Handler() { SAMDTimerStatic<TIMER_TC3, callback>::handleInterrupt(); }
+
+#if (TIMER_INTERRUPT_USING_SAMD21)
+  #define SAMD_TIMER_ISR_TCC(callback)    SAMD_TIMER_RAMFUNC void TCC0_Handler() { SAMDTimerStatic<TIMER_TCC, callback>::handleInterrupt(); }
+#endif
+
 #endif    // #ifndef SAMD_TIMERINTERRUPT_HPP
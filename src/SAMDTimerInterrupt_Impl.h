@@ -49,62 +49,224 @@
 #define SAMD_TIMERINTERRUPT_IMPL_H
 
 
+////////////////////////////////////////////////////
+
+// Last timer attached in periodic mode on each TC / TCC, retuned by SAMD_setClockError(). NULL => none
+SAMDTimerInterrupt* SAMD_clockTimer[MAX_TIMER];
+
+SAMDTimerInterrupt::~SAMDTimerInterrupt()
+{
+  if (SAMD_clockTimer[_timerNumber] == this)
+    SAMD_clockTimer[_timerNumber] = NULL;
+}
+
 ////////////////////////////////////////////////////
 
 #if (TIMER_INTERRUPT_USING_SAMD51)
 
   timerCallback TC3_callback;
+  
+  // Run limit of attachInterruptIntervalCount(), counted down by the handler. 0 => run indefinitely
+  volatile uint32_t TC3_runsLeft = 0;
+  timerCallback     TC3_doneCallback = NULL;
+  
+#if (USING_LATENCY_PROBE)
+  SAMDLatencyProbe  TC3_latency = { 0, 0xFFFFFFFF, 0, 0, { 0 } };
+#endif
+  
+  // Phase accumulator for setFrequencyExact(). TC3_phaseStep == 0 => normal fixed-period mode
+  volatile uint16_t TC3_baseCompare;
+  volatile uint32_t TC3_phaseStep = 0;
+  volatile uint32_t TC3_phaseAcc;
+  
+  // Free-running compare-channel mode (beginCompareChannels()). Bit n set => CCn armed. 0 => normal periodic mode
+  volatile uint8_t  TC3_channelMask = 0;
+  timerCallback     TC3_channelCallback[SAMD_TC3_NUM_CHANNELS];
+  volatile uint16_t TC3_channelStep[SAMD_TC3_NUM_CHANNELS];
+  volatile uint16_t TC3_channelNext[SAMD_TC3_NUM_CHANNELS];
 
   //#define SAMD_TC3        ((TcCount16*) _SAMDTimer)
 
-  void TC3_Handler() 
+#if !defined(USING_TC3_STATIC_HANDLER)
+
+  SAMD_TIMER_RAMFUNC void TC3_Handler()
   {
+    if (TC3_channelMask)
+    {
+      // Advance each matched channel by its own period, then dispatch it. The 16-bit CC wraps with the counter
+      uint8_t flags = TC3->COUNT16.INTFLAG.reg;
+      
+      for (uint8_t channel = 0; channel < SAMD_TC3_NUM_CHANNELS; channel++)
+      {
+        if ( (TC3_channelMask & (1 << channel)) && (flags & TC_INTFLAG_MC(1 << channel)) )
+        {
+          TC3->COUNT16.INTFLAG.reg = TC_INTFLAG_MC(1 << channel);
+          
+          TC3_channelNext[channel]     += TC3_channelStep[channel];
+          TC3->COUNT16.CC[channel].reg  = TC3_channelNext[channel];
+          
+          (*TC3_channelCallback[channel])();
+        }
+      }
+      
+      return;
+    }
+    
     // If this interrupt is due to the compare register matching the timer count
     if (TC3->COUNT16.INTFLAG.bit.MC0 == 1) 
     {
       TC3->COUNT16.INTFLAG.bit.MC0 = 1;
+      
+      if (TC3_phaseStep)
+      {
+        // The period just started is N + 1 ticks whenever the accumulator carries, else N ticks
+        uint32_t phase = TC3_phaseAcc + TC3_phaseStep;
+        
+        TC3->COUNT16.CC[0].reg = TC3_baseCompare + (phase < TC3_phaseAcc);
+        TC3_phaseAcc = phase;
+      }
+      
+#if (USING_LATENCY_PROBE)
+      // Ticks since the match
+      TC3->COUNT16.CTRLBSET.reg = TC_CTRLBSET_CMD_READSYNC;
+      while (TC3->COUNT16.SYNCBUSY.bit.CTRLB);
+      while (TC3->COUNT16.CTRLBSET.bit.CMD);
+      while (TC3->COUNT16.SYNCBUSY.bit.COUNT);
+      
+      uint32_t ticks = TC3->COUNT16.COUNT.reg;
+      
+      SAMD_recordLatency(TC3_latency, ticks);
+#endif
+
       (*TC3_callback)();
+      
+      if ( TC3_runsLeft && (--TC3_runsLeft == 0) )
+      {
+        // Last period done: stop the counter here, so no more interrupts, then report
+        TC3->COUNT16.CTRLA.bit.ENABLE = 0;
+        
+        if (TC3_doneCallback)
+          (*TC3_doneCallback)();
+      }
     }
   }
 
+#endif    // #if !defined(USING_TC3_STATIC_HANDLER)
+
   bool SAMDTimerInterrupt::_setPeriod(const float& _period, timerCallback callback)
   {
     if (_timerNumber == TIMER_TC3)
-    {    
-      TISR_LOGWARN3(F("SAMDTimerInterrupt: F_CPU (MHz) ="), F_CPU/1000000, F(", TIMER_HZ ="), TIMER_HZ/1000000);
-      TISR_LOGWARN3(F("TC_Timer::startTimer _Timer = 0x"), String((uint32_t) _SAMDTimer, HEX), F(", TC3 = 0x"), String((uint32_t) TC3, HEX));
-
-      // Enable the TC bus clock, use clock generator 0
-      GCLK->PCHCTRL[TC3_GCLK_ID].reg = GCLK_PCHCTRL_GEN_GCLK1_Val | (1 << GCLK_PCHCTRL_CHEN_Pos);
+    {
+      // Back to fixed-period mode. setFrequencyExact() re-arms the phase accumulator afterwards
+      TC3_phaseStep     = 0;
+      TC3_channelMask   = 0;
+      _asyncState       = SAMD_ASYNC_IDLE;
       
-      while (GCLK->SYNCBUSY.reg > 0);
-
-      TC3->COUNT16.CTRLA.bit.ENABLE = 0;
+      if (_compareChannels || (_oneShotDelay != 0))
+      {
+        // Counter was left free running or in one-shot mode, redo the full initialization
+        _compareChannels  = false;
+        _oneShotDelay     = 0;
+        initialized       = false;
+      }
       
-      // Use match mode so that the timer counter resets when the count matches the
-      // compare register
-      TC3->COUNT16.WAVE.bit.WAVEGEN = TC_WAVE_WAVEGEN_MFRQ;
-      TC3_wait_for_sync();
+      if ( initialized && (_period == _lastPeriod) && (_lastClockError == SAMD_clockErrorPpb) &&
+           TC3->COUNT16.CTRLA.bit.ENABLE && !TC3->COUNT16.STATUS.bit.STOP )
+      {
+        // Same hardware state as the last attach, only the callback slot changes
+        setCallback(callback);
+        
+        // Back to the sub-tick part of the corrected period, cleared above
+        if (SAMD_clockErrorPpb != 0)
+          applyClockError();
+        
+        enableIRQ();
+        
+        return true;
+      }
       
-       // Enable the compare interrupt
-      TC3->COUNT16.INTENSET.reg = 0;
-      TC3->COUNT16.INTENSET.bit.MC0 = 1;
+      if (!initialized)
+      {
+        TISR_LOGWARN3(F("SAMDTimerInterrupt: F_CPU (MHz) ="), F_CPU/1000000, F(", Timer clock (Hz) ="), _timerHz);
+        TISR_LOGWARN3(F("TC_Timer::startTimer _Timer = 0x"), TISR_HEX(_SAMDTimer), F(", TC3 = 0x"), TISR_HEX(TC3));
 
-      // Enable IRQ
-      NVIC_EnableIRQ(TC3_IRQn);
+        // Enable the TC bus clock, from the selected clock generator (GCLK1 by default)
+        GCLK->PCHCTRL[TC3_GCLK_ID].reg = GCLK_PCHCTRL_GEN(_gclkGenerator) | (1 << GCLK_PCHCTRL_CHEN_Pos);
+        
+        while (GCLK->SYNCBUSY.reg > 0);
 
-      //func1 = f;
-      _callback     = callback;
-      TC3_callback  = callback;
+        TC3->COUNT16.CTRLA.bit.ENABLE = 0;
+        
+        // Use match mode so that the timer counter resets when the count matches the
+        // compare register. Periodic again after fireOnceAfter()
+        TC3->COUNT16.WAVE.bit.WAVEGEN = TC_WAVE_WAVEGEN_MFRQ;
+        TC3->COUNT16.CTRLBCLR.reg     = TC_CTRLBCLR_ONESHOT;
+        TC3_wait_for_sync();
+        
+         // Enable the compare interrupt, and only that one
+        TC3->COUNT16.INTENCLR.reg = TC_INTENCLR_MASK;
+        TC3->COUNT16.INTENSET.reg = TC_INTENSET_MC0;
+        
+        initialized = true;
+      }
+
+      setCallback(callback);
 
-      //setPeriod(period);
+      // Only the prescaler and CC0 from now on
       setPeriod_TIMER_TC3(_period);
       
+      _lastPeriod     = _period;
+      _lastClockError = SAMD_clockErrorPpb;
+      _trimPeriod     = _period;
+      
+      SAMD_clockTimer[_timerNumber] = this;
+      
+      // CC0 only holds whole ticks of the corrected clock, the accumulator adds the rest
+      if (SAMD_clockErrorPpb != 0)
+        applyClockError();
+      
+      // Enable IRQ, also after detachInterrupt()
+      enableIRQ();
+      
       return true;
     }
     else
       return false;
   }
+  
+  void SAMDTimerInterrupt::setCallback(timerCallback callback)
+  {
+    // The handler must not see the new limit with the old callback. Masked until the enableIRQ() of the attach
+    NVIC_DisableIRQ(TC3_IRQn);
+    
+    _callback         = callback;
+    TC3_callback      = callback;
+    TC3_runsLeft      = _runLimit;
+    TC3_doneCallback  = _doneCallback;
+    
+    // The limit applies to this attach only
+    _runLimit         = 0;
+    _doneCallback     = NULL;
+  }
+  
+  uint32_t SAMDTimerInterrupt::getRemainingRuns()
+  {
+    return TC3_runsLeft;
+  }
+  
+  double SAMDTimerInterrupt::getPeriod()
+  {
+    double ticks = (TC3_phaseStep != 0) ? (TC3_baseCompare + 1 + TC3_phaseStep / 4294967296.0) : 
+                                          (TC3->COUNT16.CC[0].reg + 1.0);
+    
+    return ticks * _prescaler * 1000000.0 / clockHz();
+  }
+  
+  double SAMDTimerInterrupt::getMaxPeriod()
+  {
+    // 16-bit CC0 at DIV1024
+    return 65535.0 * 1024 * 1000000.0 / clockHz();
+  }
 
   // frequency (in hertz) and duration (in milliseconds). Duration = 0 or not specified => run indefinitely
   // No params and duration now. To be addes in the future by adding similar functions here or to SAMD-hal-timer.c
@@ -114,143 +276,1810 @@
     return _setPeriod(_period, callback);
   }
 
+  bool SAMDTimerInterrupt::setFrequencyExact(const float& frequency, timerCallback callback)
+  {
+    if (frequency <= 0)
+      return false;
+      
+    // Same prescaler as setFrequency() selects. Checked before attaching, so a failure leaves the timer untouched
+    uint16_t prescaler  = SAMD_prescalerDivider[SAMD_periodPrescalerIndex((1000000.0f / frequency) * ((float) _timerHz / TIMER_HZ))];
 
-////////////////////////////////////////////////////////
+    // Ideal period in (prescaled) timer ticks, split into whole ticks and a 32-bit binary fraction
+    double   ticks      = clockHz() / prescaler / frequency;
+    uint32_t wholeTicks = (uint32_t) ticks;
+    uint32_t phaseStep  = (uint32_t) ((ticks - wholeTicks) * 4294967296.0);
 
-#elif (TIMER_INTERRUPT_USING_SAMD21)
+    // CC is period - 1, and N + 1 must still fit the 16-bit counter
+    if ( (wholeTicks < 2) || (wholeTicks > 0xFFFF) )
+      return false;
+      
+    if (!setFrequency(frequency, callback))
+      return false;
 
-  timerCallback TC3_callback;
-  timerCallback TCC_callback;
+    noInterrupts();
+    
+    TC3_baseCompare = wholeTicks - 1;
+    TC3_phaseAcc    = 0;
+    TC3_phaseStep   = phaseStep;
+    
+    interrupts();
+    
+    // The ISR now moves CC every period
+    _lastPeriod     = 0;
+    _trimPeriod     = 1000000.0 / frequency;
 
-////////////////////////////////////////////////////////
+    _frequencyError = (float) ( clockHz() / _prescaler / (wholeTicks + phaseStep / 4294967296.0) - frequency );
 
+    TISR_LOGDEBUG3(F("setFrequencyExact: N ="), wholeTicks, F(", phaseStep ="), phaseStep);
+    TISR_LOGDEBUG1(F("Frequency error (Hz) ="), _frequencyError);
 
-  void TC3_Handler()
+    return true;
+  }
+  
+  bool SAMDTimerInterrupt::applyClockError()
   {
-    // get timer struct
-	  TcCount16* TC = (TcCount16*) TC3;
-	  
-    // If the compare register matching the timer count, trigger this interrupt
-    if (TC->INTFLAG.bit.MC0 == 1) 
-    {
-      TC->INTFLAG.bit.MC0 = 1;
-		  (*TC3_callback)();
-    }
+    if ( !initialized || (_trimPeriod == 0) || (_asyncState != SAMD_ASYNC_IDLE) )
+      return false;
+      
+    // Same split as setFrequencyExact(), at the running prescaler
+    double   ticks      = clockHz() / _prescaler * (_trimPeriod / 1000000.0);
+    uint32_t wholeTicks = (uint32_t) ticks;
+    uint32_t phaseStep  = (uint32_t) ((ticks - wholeTicks) * 4294967296.0);
+    
+    if ( (wholeTicks < 2) || (wholeTicks > 0xFFFF) )
+      return false;
+      
+    // Also called from interrupt handlers, e.g. by SAMDTimerDiscipline
+    uint32_t primask = __get_PRIMASK();
+    
+    __disable_irq();
+    
+    TC3_baseCompare = wholeTicks - 1;
+    TC3_phaseStep   = phaseStep;
+    
+    __set_PRIMASK(primask);
+    
+    // Latched at the next match, so the running period completes. With a phase step, the ISR takes over from there
+    TC3->COUNT16.CCBUF[0].reg = wholeTicks - 1;
+    
+    _lastClockError = SAMD_clockErrorPpb;
+    
+    TISR_LOGDEBUG3(F("applyClockError: N ="), wholeTicks, F(", phaseStep ="), phaseStep);
+    
+    return true;
   }
 
-  void TCC0_Handler()
+  bool SAMDTimerInterrupt::setPeriodBuffered(const float& period)
   {
-    // get timer struct
-    Tcc* TC = (Tcc*) TCC0;
+    if (_callback == NULL)
+      return false;
+
+    uint32_t _compareValue = (uint32_t) (clockHz() / (_prescaler / (period / 1000000.0))) - 1;
+
+    if ( (_compareValue < 1) || (_compareValue > 0xFFFF) )
+      return false;
+
+    // The ISR would overwrite CC on its next run
+    TC3_phaseStep = 0;
+    _lastPeriod   = 0;
+    _trimPeriod   = period;
     
-    // If the compare register matching the timer count, trigger this interrupt
-    if (TC->INTFLAG.bit.MC0 == 1) 
-    {  
-      // A compare to cc0 caused the interrupt
-	    TC->INTFLAG.bit.MC0 = 1;    // writing a one clears the flag ovf flag
-    }
+    TC3->COUNT16.CCBUF[0].reg = _compareValue;
+    
+    TISR_LOGDEBUG3(F("setPeriodBuffered: period ="), period, F(", _compareValue ="), _compareValue);
 
-    if (TC->INTFLAG.bit.OVF == 1) 
-    {
-	    (*TCC_callback)();
-	    
-	    TC->INTFLAG.bit.OVF = 1;
-    }
+    return true;
   }
-     
-  bool SAMDTimerInterrupt::_setPeriod(const float& _period, timerCallback callback)
+
+  bool SAMDTimerInterrupt::setPeriodAsync(const float& period)
   {
-    TISR_LOGDEBUG1(F("_period ="), _period);
+    if ( !initialized || (_asyncState != SAMD_ASYNC_IDLE) || (period <= 0) )
+      return false;
+      
+    uint8_t  prescalerIndex = SAMD_periodPrescalerIndex(period * ((float) _timerHz / TIMER_HZ));
+    uint32_t _compareValue  = (uint32_t) (clockHz() / (SAMD_prescalerDivider[prescalerIndex] / (period / 1000000.0))) - 1;
     
-    if (_timerNumber == TIMER_TC3)
+    if ( (_compareValue < 1) || (_compareValue > 0xFFFF) )
+      return false;
+      
+    TC3_phaseStep   = 0;
+    _prescaler      = SAMD_prescalerDivider[prescalerIndex];
+    _lastPeriod     = 0;
+    _trimPeriod     = period;
+    
+    uint32_t ctrla  = TC3->COUNT16.CTRLA.reg;
+    
+    if ( (ctrla & TC_CTRLA_ENABLE) && ((ctrla & TC_CTRLA_PRESCALER_Msk) == TC_CTRLA_PRESCALER(prescalerIndex)) )
     {
-      noInterrupts();
-      if (!initialized)
-      {
-        REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID (GCM_TCC2_TC3));
-        while ( GCLK->STATUS.bit.SYNCBUSY);
-                
-        TISR_LOGWARN3(F("SAMDTimerInterrupt: F_CPU (MHz) ="), F_CPU/1000000, F(", TIMER_HZ ="), TIMER_HZ/1000000);
-        TISR_LOGWARN3(F("TC3_Timer::startTimer _Timer = 0x"), String((uint32_t) _SAMDTimer, HEX), F(", TC3 = 0x"), String((uint32_t) TC3, HEX));
-
-        SAMD_TC3->CTRLA.reg &= ~TC_CTRLA_ENABLE;
-  
-        // Use the 16-bit timer
-        SAMD_TC3->CTRLA.reg |= TC_CTRLA_MODE_COUNT16;
-        while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+      // CCBUF isn't synchronized, and the hardware latches it at the next match
+      TC3->COUNT16.CCBUF[0].reg = _compareValue;
+      
+      return true;
+    }
+    
+    _asyncPrescaler = prescalerIndex;
+    _asyncCompare   = _compareValue;
+    _asyncState     = SAMD_ASYNC_DISABLE;
+    
+    pollPeriodAsync();
+    
+    return true;
+  }
   
-        // Use match mode so that the timer counter resets when the count matches the compare register
-        SAMD_TC3->CTRLA.reg |= TC_CTRLA_WAVEGEN_MFRQ;
-        while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+  bool SAMDTimerInterrupt::getLatencyStats(SAMDLatencyStats& stats)
+  {
+#if (USING_LATENCY_PROBE)
+    return SAMD_readLatency(TC3_latency, (float) F_CPU * _prescaler / _timerHz, stats);
+#else
+    (void) stats;
     
-        // Enable the compare interrupt
-        SAMD_TC3->INTENSET.reg = 0;
-        SAMD_TC3->INTENSET.bit.MC0 = 1;
+    return false;
+#endif
+  }
   
-        _callback     = callback;
-        TC3_callback  = callback;
-
-        NVIC_EnableIRQ(TC3_IRQn);
+  void SAMDTimerInterrupt::resetLatencyStats()
+  {
+#if (USING_LATENCY_PROBE)
+    SAMD_resetLatency(TC3_latency);
+#endif
+  }
   
-        setPeriod_TIMER_TC3(_period); // this also enables the timer
-
-        initialized = true;
-      }
-      else
+  bool SAMDTimerInterrupt::pollPeriodAsync()
+  {
+    while (_asyncState != SAMD_ASYNC_IDLE)
+    {
+      // Each step writes only once the previous write is synchronized, so the CPU never waits
+      if (TC3->COUNT16.SYNCBUSY.reg != 0)
+        return false;
+        
+      switch (_asyncState)
       {
-        setPeriod_TIMER_TC3(_period);
-        _callback     = callback;
-        TC3_callback  = callback;
+        case SAMD_ASYNC_DISABLE:
+          TC3->COUNT16.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+          break;
+          
+        case SAMD_ASYNC_PRESCALER:
+          // Not synchronized on SAMD51, CC0 and COUNT follow right away
+          TC3->COUNT16.CTRLA.reg  = (TC3->COUNT16.CTRLA.reg & ~TC_CTRLA_PRESCALER_Msk) | TC_CTRLA_PRESCALER(_asyncPrescaler);
+          TC3->COUNT16.CC[0].reg  = _asyncCompare;
+          TC3->COUNT16.COUNT.reg  = 0;
+          _asyncState             = SAMD_ASYNC_COUNT;
+          break;
+          
+        case SAMD_ASYNC_ENABLE:
+          TC3->COUNT16.CTRLA.reg |= TC_CTRLA_ENABLE;
+          break;
+          
+        default:
+          break;
       }
-      interrupts();
+      
+      _asyncState = (_asyncState == SAMD_ASYNC_FINISH) ? SAMD_ASYNC_IDLE : (SAMDAsyncState) (_asyncState + 1);
     }
-    else if (_timerNumber == TIMER_TCC)
-    {
-      REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID(GCM_TCC0_TCC1));
     
-      while ( GCLK->STATUS.bit.SYNCBUSY == 1 );
-      
-      TISR_LOGWARN3(F("SAMDTimerInterrupt: F_CPU (MHz) ="), F_CPU/1000000, F(", TIMER_HZ ="), TIMER_HZ/1000000);
-      TISR_LOGWARN3(F("TCC_Timer::startTimer _Timer = 0x"), String((uint32_t) _SAMDTimer, HEX), F(", TCC0 = 0x"), String((uint32_t) TCC0, HEX));
-     
-      SAMD_TCC->CTRLA.reg &= ~TCC_CTRLA_ENABLE;   // Disable TC
-      
-      while (SAMD_TCC->SYNCBUSY.bit.ENABLE == 1); // wait for sync 
-            
-      setPeriod_TIMER_TCC(_period);
+    return true;
+  }
 
-      // Use match mode so that the timer counter resets when the count matches the compare register
-      SAMD_TCC->WAVE.reg |= TCC_WAVE_WAVEGEN_NFRQ;   // Set wave form configuration 
+  bool SAMDTimerInterrupt::configureClockGenerator(const uint8_t& generator, const uint8_t& source, const uint32_t& sourceHz, 
+                                                   const uint16_t& divider)
+  {
+    if ( (generator >= GCLK_GEN_NUM) || (divider == 0) )
+      return false;
       
-      while (SAMD_TCC->SYNCBUSY.bit.WAVE == 1); // wait for sync 
-
-      // Enable the compare interrupt
-      SAMD_TCC->INTENSET.reg = 0;
-      SAMD_TCC->INTENSET.bit.OVF = 1;
-      SAMD_TCC->INTENSET.bit.MC0 = 1;
+    // generator 1 has a 16-bit divider, the others 8-bit
+    if ( (generator != 1) && (divider > 0xFF) )
+      return false;
+      
+    GCLK->GENCTRL[generator].reg = GCLK_GENCTRL_SRC(source) | GCLK_GENCTRL_DIV(divider) | GCLK_GENCTRL_IDC | GCLK_GENCTRL_GENEN;
+    
+    while (GCLK->SYNCBUSY.reg > 0);
+    
+    TISR_LOGWARN3(F("configureClockGenerator: GCLK"), generator, F(", Hz ="), sourceHz / divider);
 
-      NVIC_EnableIRQ(TCC0_IRQn);
+    return setClockSource(generator, sourceHz / divider);
+  }
 
-      SAMD_TCC->CTRLA.reg |= TCC_CTRLA_ENABLE;
+  bool SAMDTimerInterrupt::beginCompareChannels(const float& maxPeriod)
+  {
+    if (_timerNumber != TIMER_TC3)
+      return false;
       
-      while (SAMD_TCC->SYNCBUSY.bit.ENABLE == 1); // wait for sync 
-
-      _callback     = callback;
-      TCC_callback  = callback;
-    }
+    uint8_t prescalerIndex = SAMD_selectPrescaler(maxPeriod, _timerHz, 0xFFFF);
+    
+    _prescaler = SAMD_prescalerDivider[prescalerIndex];
+    
+    GCLK->PCHCTRL[TC3_GCLK_ID].reg = GCLK_PCHCTRL_GEN(_gclkGenerator) | (1 << GCLK_PCHCTRL_CHEN_Pos);
+    while (GCLK->SYNCBUSY.reg > 0);
+    
+    TC3->COUNT16.CTRLA.bit.ENABLE = 0;
+    TC3_wait_for_sync();
+    
+    // 16-bit counter running over its full range
+    TC3->COUNT16.CTRLA.reg      = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_PRESCALER(prescalerIndex);
+    TC3->COUNT16.WAVE.reg       = TC_WAVE_WAVEGEN_NFRQ;
+    TC3->COUNT16.CTRLBCLR.reg   = TC_CTRLBCLR_ONESHOT;
+    TC3->COUNT16.COUNT.reg      = 0;
+    TC3_wait_for_sync();
+    
+    TC3->COUNT16.INTENCLR.reg = TC_INTENCLR_MASK;
+    TC3->COUNT16.INTFLAG.reg  = TC_INTFLAG_MASK;
+    
+    TC3_phaseStep     = 0;
+    TC3_channelMask   = 0;
+    
+    _callback         = NULL;
+    _compareChannels  = true;
+    _oneShotDelay     = 0;
+    _trimPeriod       = 0;
+    
+    enableIRQ();
+    
+    TISR_LOGDEBUG3(F("beginCompareChannels: maxPeriod ="), maxPeriod, F(", _prescaler ="), _prescaler);
+    
+    return true;
+  }
   
+  bool SAMDTimerInterrupt::attachCompareInterrupt(const uint8_t& channel, const float& offset, const float& period, 
+                                                  timerCallback callback)
+  {
+    if ( !_compareChannels || (channel >= SAMD_TC3_NUM_CHANNELS) || (callback == NULL) )
+      return false;
+      
+    float    ticksPerUs   = clockHz() / 1000000.0f / _prescaler;
+    uint32_t periodTicks  = (uint32_t) (period * ticksPerUs + 0.5f);
+    uint32_t offsetTicks  = (uint32_t) (offset * ticksPerUs + 0.5f);
+    
+    if ( (periodTicks == 0) || (periodTicks > 0xFFFF) || (offsetTicks > 0xFFFF) )
+      return false;
+    
+    // Counter is still at 0 before startCompareChannels(). READSYNC is ignored while the TC is disabled, don't wait on it
+    uint16_t origin = TC3->COUNT16.CTRLA.bit.ENABLE ? readCount() : 0;
+    
+    noInterrupts();
+    
+    TC3_channelCallback[channel]  = callback;
+    TC3_channelStep[channel]      = periodTicks;
+    TC3_channelNext[channel]      = origin + offsetTicks;
+    
+    TC3->COUNT16.CC[channel].reg  = TC3_channelNext[channel];
+    TC3_wait_for_sync();
+    
+    TC3->COUNT16.INTFLAG.reg      = TC_INTFLAG_MC(1 << channel);
+    TC3_channelMask              |= (1 << channel);
+    TC3->COUNT16.INTENSET.reg     = TC_INTENSET_MC(1 << channel);
+    
+    interrupts();
+    
+    TISR_LOGDEBUG3(F("attachCompareInterrupt: channel ="), channel, F(", periodTicks ="), periodTicks);
+    
     return true;
   }
   
-  // frequency (in hertz) and duration (in milliseconds). Duration = 0 or not specified => run indefinitely
-  // No params and duration now. To be addes in the future by adding similar functions here or to SAMD-hal-timer.c
-  bool SAMDTimerInterrupt::setFrequency(const float& frequency, timerCallback callback)
+  void SAMDTimerInterrupt::detachCompareInterrupt(const uint8_t& channel)
   {
-    float _period =  (1000000.0f / frequency);
-    TISR_LOGDEBUG3(F("_period ="), _period, F(", frequency ="), frequency);
-    return _setPeriod(_period, callback);
+    if (channel >= SAMD_TC3_NUM_CHANNELS)
+      return;
+      
+    noInterrupts();
+    
+    TC3->COUNT16.INTENCLR.reg = TC_INTENCLR_MC(1 << channel);
+    TC3_channelMask          &= ~(1 << channel);
+    
+    interrupts();
   }
-
-#endif    // #if (TIMER_INTERRUPT_USING_SAMD51)
+  
+  void SAMDTimerInterrupt::startCompareChannels()
+  {
+    TC3->COUNT16.CTRLA.bit.ENABLE = 1;
+    TC3_wait_for_sync();
+  }
+  
+  bool SAMDTimerInterrupt::fireOnceAfter(const float& delay, timerCallback callback)
+  {
+    if ( (delay <= 0) || (callback == NULL) )
+      return false;
+      
+    if (delay == _oneShotDelay)
+    {
+      // Already armed for this delay, only restart it
+      _callback     = callback;
+      TC3_callback  = callback;
+      
+      retriggerOneShot();
+      
+      return true;
+    }
+    
+    uint8_t  prescalerIndex = SAMD_selectPrescaler(delay, _timerHz, 0xFFFF);
+    uint32_t ticks          = (uint32_t) (delay * (clockHz() / 1000000.0f) / SAMD_prescalerDivider[prescalerIndex] + 0.5f);
+    
+    if ( (ticks == 0) || (ticks > 0xFFFF) )
+      return false;
+      
+    GCLK->PCHCTRL[TC3_GCLK_ID].reg = GCLK_PCHCTRL_GEN(_gclkGenerator) | (1 << GCLK_PCHCTRL_CHEN_Pos);
+    while (GCLK->SYNCBUSY.reg > 0);
+    
+    TC3->COUNT16.CTRLA.bit.ENABLE = 0;
+    TC3_wait_for_sync();
+    
+    // MC0 fires when the count reaches CC0, 'ticks' after the start, and the counter stops at the following wrap
+    TC3->COUNT16.CTRLA.reg    = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_PRESCALER(prescalerIndex);
+    TC3->COUNT16.WAVE.reg     = TC_WAVE_WAVEGEN_MFRQ;
+    TC3->COUNT16.CTRLBSET.reg = TC_CTRLBSET_ONESHOT;
+    TC3_wait_for_sync();
+    
+    TC3->COUNT16.CC[0].reg    = ticks;
+    TC3->COUNT16.COUNT.reg    = 0;
+    TC3_wait_for_sync();
+    
+    TC3->COUNT16.INTENCLR.reg = TC_INTENCLR_MASK;
+    TC3->COUNT16.INTFLAG.reg  = TC_INTFLAG_MASK;
+    TC3->COUNT16.INTENSET.reg = TC_INTENSET_MC0;
+    
+    TC3_phaseStep     = 0;
+    TC3_channelMask   = 0;
+    TC3_runsLeft      = 0;
+    
+    _prescaler        = SAMD_prescalerDivider[prescalerIndex];
+    _compareChannels  = false;
+    _oneShotDelay     = delay;
+    _trimPeriod       = 0;
+    _callback         = callback;
+    TC3_callback      = callback;
+    
+    enableIRQ();
+    
+    // Enabling starts the first shot
+    TC3->COUNT16.CTRLA.bit.ENABLE = 1;
+    TC3_wait_for_sync();
+    
+    TISR_LOGDEBUG3(F("fireOnceAfter: delay ="), delay, F(", ticks ="), ticks);
+    
+    return true;
+  }
+  
+  // Keeps TC3_callback valid while the timer runs as a trigger source only
+  void SAMD_triggerOnlyCallback()
+  {
+  }
+  
+  bool SAMDTimerInterrupt::setTriggerPeriod(const float& period)
+  {
+    if (!_setPeriod(period, SAMD_triggerOnlyCallback))
+      return false;
+      
+    // Overflow still raises the DMA / event triggers, the CPU is never interrupted. So no ISR to run the accumulator
+    TC3->COUNT16.INTENCLR.reg = TC_INTENCLR_MASK;
+    TC3_phaseStep             = 0;
+    
+    // The next attach must enable MC0 again
+    initialized = false;
+    
+    return true;
+  }
+  
+  void SAMDTimerInterrupt::enableEventOutput()
+  {
+    // EVCTRL is enable-protected
+    bool wasEnabled = TC3->COUNT16.CTRLA.bit.ENABLE;
+    
+    TC3->COUNT16.CTRLA.bit.ENABLE = 0;
+    TC3_wait_for_sync();
+    
+    TC3->COUNT16.EVCTRL.reg |= TC_EVCTRL_OVFEO;
+    
+    if (wasEnabled)
+    {
+      TC3->COUNT16.CTRLA.bit.ENABLE = 1;
+      TC3_wait_for_sync();
+    }
+  }
+
+
+////////////////////////////////////////////////////////
+
+#elif (TIMER_INTERRUPT_USING_SAMD21)
+
+  timerCallback TC3_callback;
+  timerCallback TCC_callback;
+  
+  // Run limits of attachInterruptIntervalCount(), counted down by the handlers. 0 => run indefinitely
+  volatile uint32_t TC3_runsLeft = 0;
+  volatile uint32_t TCC_runsLeft = 0;
+  timerCallback     TC3_doneCallback = NULL;
+  timerCallback     TCC_doneCallback = NULL;
+  
+#if (USING_LATENCY_PROBE)
+  SAMDLatencyProbe  TC3_latency = { 0, 0xFFFFFFFF, 0, 0, { 0 } };
+  SAMDLatencyProbe  TCC_latency = { 0, 0xFFFFFFFF, 0, 0, { 0 } };
+#endif
+  
+  // Phase accumulators for setFrequencyExact(). phaseStep == 0 => normal fixed-period mode
+  volatile uint16_t TC3_baseCompare;
+  volatile uint32_t TC3_phaseStep = 0;
+  volatile uint32_t TC3_phaseAcc;
+  
+  volatile uint32_t TCC_basePeriod;
+  volatile uint32_t TCC_phaseStep = 0;
+  volatile uint32_t TCC_phaseAcc;
+  
+  // Compare value for setPeriodBuffered() on TC3, applied by the ISR at the next match. -1 => nothing pending
+  volatile int32_t  TC3_pendingCompare = -1;
+  
+  // Free-running compare-channel mode (beginCompareChannels()). Bit n set => CCn armed. 0 => normal periodic mode
+  volatile uint8_t  TC3_channelMask = 0;
+  timerCallback     TC3_channelCallback[SAMD_TC3_NUM_CHANNELS];
+  volatile uint16_t TC3_channelStep[SAMD_TC3_NUM_CHANNELS];
+  volatile uint16_t TC3_channelNext[SAMD_TC3_NUM_CHANNELS];
+  
+  volatile uint8_t  TCC_channelMask = 0;
+  timerCallback     TCC_channelCallback[SAMD_TCC_NUM_CHANNELS];
+  volatile uint32_t TCC_channelStep[SAMD_TCC_NUM_CHANNELS];
+  volatile uint32_t TCC_channelNext[SAMD_TCC_NUM_CHANNELS];
+
+////////////////////////////////////////////////////////
+
+
+#if !defined(USING_TC3_STATIC_HANDLER)
+
+  SAMD_TIMER_RAMFUNC void TC3_Handler()
+  {
+    // get timer struct
+	  TcCount16* TC = (TcCount16*) TC3;
+	  
+    if (TC3_channelMask)
+    {
+      // Advance each matched channel by its own period, then dispatch it. The 16-bit CC wraps with the counter
+      uint8_t flags = TC->INTFLAG.reg;
+      
+      for (uint8_t channel = 0; channel < SAMD_TC3_NUM_CHANNELS; channel++)
+      {
+        if ( (TC3_channelMask & (1 << channel)) && (flags & TC_INTFLAG_MC(1 << channel)) )
+        {
+          TC->INTFLAG.reg = TC_INTFLAG_MC(1 << channel);
+          
+          TC3_channelNext[channel] += TC3_channelStep[channel];
+          TC->CC[channel].reg       = TC3_channelNext[channel];
+          
+          (*TC3_channelCallback[channel])();
+        }
+      }
+      
+      return;
+    }
+    
+    // If the compare register matching the timer count, trigger this interrupt
+    if (TC->INTFLAG.bit.MC0 == 1) 
+    {
+      TC->INTFLAG.bit.MC0 = 1;
+      
+      if (TC3_pendingCompare >= 0)
+      {
+        // Software double buffering: the new period starts right at this match
+        TC->CC[0].reg       = TC3_pendingCompare;
+        TC3_pendingCompare  = -1;
+      }
+      else if (TC3_phaseStep)
+      {
+        // The period just started is N + 1 ticks whenever the accumulator carries, else N ticks
+        uint32_t phase = TC3_phaseAcc + TC3_phaseStep;
+        
+        TC->CC[0].reg = TC3_baseCompare + (phase < TC3_phaseAcc);
+        TC3_phaseAcc  = phase;
+      }
+      
+#if (USING_LATENCY_PROBE)
+      // Ticks since the match
+      TC->READREQ.reg = TC_READREQ_RREQ | TC_READREQ_ADDR(0x10);
+      while (TC->STATUS.bit.SYNCBUSY);
+      
+      uint32_t ticks = TC->COUNT.reg;
+      
+      SAMD_recordLatency(TC3_latency, ticks);
+#endif
+
+		  (*TC3_callback)();
+      
+      if ( TC3_runsLeft && (--TC3_runsLeft == 0) )
+      {
+        // Last period done: stop the counter here, so no more interrupts, then report
+        TC->CTRLA.reg &= ~TC_CTRLA_ENABLE;
+        
+        if (TC3_doneCallback)
+          (*TC3_doneCallback)();
+      }
+    }
+  }
+
+#endif    // #if !defined(USING_TC3_STATIC_HANDLER)
+
+#if !defined(USING_TCC_STATIC_HANDLER)
+
+  SAMD_TIMER_RAMFUNC void TCC0_Handler()
+  {
+    // get timer struct
+    Tcc* TC = (Tcc*) TCC0;
+    
+    if (TCC_channelMask)
+    {
+      // Advance each matched channel by its own period, then dispatch it. CC wraps with the 24-bit counter
+      uint32_t flags = TC->INTFLAG.reg;
+      
+      for (uint8_t channel = 0; channel < SAMD_TCC_NUM_CHANNELS; channel++)
+      {
+        if ( (TCC_channelMask & (1 << channel)) && (flags & TCC_INTFLAG_MC(1 << channel)) )
+        {
+          TC->INTFLAG.reg = TCC_INTFLAG_MC(1 << channel);
+          
+          TCC_channelNext[channel]  = (TCC_channelNext[channel] + TCC_channelStep[channel]) & 0xFFFFFF;
+          TC->CC[channel].reg       = TCC_channelNext[channel];
+          
+          (*TCC_channelCallback[channel])();
+        }
+      }
+      
+      return;
+    }
+    
+    // If the compare register matching the timer count, trigger this interrupt
+    if (TC->INTFLAG.bit.MC0 == 1) 
+    {  
+      // A compare to cc0 caused the interrupt
+	    TC->INTFLAG.bit.MC0 = 1;    // writing a one clears the flag ovf flag
+    }
+
+    if (TC->INTFLAG.bit.OVF == 1) 
+    {
+      if (TCC_phaseStep)
+      {
+        // PERB is latched at the next overflow, so this sets the length of the following period
+        uint32_t phase = TCC_phaseAcc + TCC_phaseStep;
+        
+        TC->PERB.reg = TCC_basePeriod + (phase < TCC_phaseAcc);
+        TCC_phaseAcc = phase;
+      }
+      
+#if (USING_LATENCY_PROBE)
+      // Ticks since the overflow
+      TC->CTRLBSET.reg = TCC_CTRLBSET_CMD_READSYNC;
+      while (TC->SYNCBUSY.bit.CTRLB);
+      while (TC->SYNCBUSY.bit.COUNT);
+      
+      uint32_t ticks = TC->COUNT.reg;
+      
+      SAMD_recordLatency(TCC_latency, ticks);
+#endif
+
+	    (*TCC_callback)();
+	    
+	    TC->INTFLAG.bit.OVF = 1;
+	    
+      if ( TCC_runsLeft && (--TCC_runsLeft == 0) )
+      {
+        // Last period done: stop the counter here, so no more interrupts, then report
+        TC->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+        
+        if (TCC_doneCallback)
+          (*TCC_doneCallback)();
+      }
+    }
+  }
+
+#endif    // #if !defined(USING_TCC_STATIC_HANDLER)
+     
+  bool SAMDTimerInterrupt::_setPeriod(const float& _period, timerCallback callback)
+  {
+    TISR_LOGDEBUG1(F("_period ="), _period);
+    
+    if (_timerNumber == TIMER_TC3)
+    {
+      noInterrupts();
+      
+      // Back to fixed-period mode. setFrequencyExact() re-arms the phase accumulator afterwards
+      TC3_phaseStep       = 0;
+      TC3_pendingCompare  = -1;
+      TC3_channelMask     = 0;
+      _asyncState         = SAMD_ASYNC_IDLE;
+      
+      if (_compareChannels)
+      {
+        // Counter was left free running, redo the full initialization
+        _compareChannels  = false;
+        initialized       = false;
+      }
+      
+      if (_oneShotDelay != 0)
+      {
+        // Counter was left in one-shot mode
+        _oneShotDelay     = 0;
+        initialized       = false;
+      }
+      
+      if ( initialized && (_period == _lastPeriod) && (_lastClockError == SAMD_clockErrorPpb) &&
+           SAMD_TC3->CTRLA.bit.ENABLE && !SAMD_TC3->STATUS.bit.STOP )
+      {
+        // Same hardware state as the last attach, only the callback slot changes
+        setCallback(callback);
+        
+        // Back to the sub-tick part of the corrected period, cleared above
+        if (SAMD_clockErrorPpb != 0)
+          applyClockError();
+        
+        enableIRQ();
+        
+        interrupts();
+        
+        return true;
+      }
+      
+      if (!initialized)
+      {
+        REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN(_gclkGenerator) | GCLK_CLKCTRL_ID (GCM_TCC2_TC3));
+        while ( GCLK->STATUS.bit.SYNCBUSY);
+                
+        TISR_LOGWARN3(F("SAMDTimerInterrupt: F_CPU (MHz) ="), F_CPU/1000000, F(", Timer clock (Hz) ="), _timerHz);
+        TISR_LOGWARN3(F("TC3_Timer::startTimer _Timer = 0x"), TISR_HEX(_SAMDTimer), F(", TC3 = 0x"), TISR_HEX(TC3));
+
+        SAMD_TC3->CTRLA.reg &= ~TC_CTRLA_ENABLE;
+  
+        // Use the 16-bit timer
+        SAMD_TC3->CTRLA.reg |= TC_CTRLA_MODE_COUNT16;
+        while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+  
+        // Use match mode so that the timer counter resets when the count matches the compare register
+        SAMD_TC3->CTRLA.reg |= TC_CTRLA_WAVEGEN_MFRQ;
+        while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+        
+        SAMD_TC3->CTRLBCLR.reg = TC_CTRLBCLR_ONESHOT;
+        while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+    
+        // Enable the compare interrupt, and only that one
+        SAMD_TC3->INTENCLR.reg = TC_INTENCLR_MASK;
+        SAMD_TC3->INTENSET.reg = 0;
+        SAMD_TC3->INTENSET.bit.MC0 = 1;
+  
+        setCallback(callback);
+
+        enableIRQ();
+  
+        setPeriod_TIMER_TC3(_period); // this also enables the timer
+
+        initialized = true;
+      }
+      else
+      {
+        setPeriod_TIMER_TC3(_period);
+        setCallback(callback);
+        
+        // Also after detachInterrupt()
+        enableIRQ();
+      }
+      
+      _lastPeriod     = _period;
+      _lastClockError = SAMD_clockErrorPpb;
+      _trimPeriod     = _period;
+      
+      SAMD_clockTimer[_timerNumber] = this;
+      
+      // CC0 only holds whole ticks of the corrected clock, the accumulator adds the rest
+      if (SAMD_clockErrorPpb != 0)
+        applyClockError();
+      
+      interrupts();
+    }
+    else if (_timerNumber == TIMER_TCC)
+    {
+      TCC_phaseStep     = 0;
+      TCC_channelMask   = 0;
+      _asyncState       = SAMD_ASYNC_IDLE;
+      
+      if (_compareChannels || (_oneShotDelay != 0))
+      {
+        // Counter was left free running or in one-shot mode, redo the full initialization
+        _compareChannels  = false;
+        _oneShotDelay     = 0;
+        initialized       = false;
+      }
+      
+      if ( initialized && (_period == _lastPeriod) && (_lastClockError == SAMD_clockErrorPpb) &&
+           SAMD_TCC->CTRLA.bit.ENABLE && !SAMD_TCC->STATUS.bit.STOP )
+      {
+        // Same hardware state as the last attach, only the callback slot changes
+        setCallback(callback);
+        
+        // Back to the sub-tick part of the corrected period, cleared above
+        if (SAMD_clockErrorPpb != 0)
+          applyClockError();
+        
+        enableIRQ();
+        
+        return true;
+      }
+      
+      if (initialized)
+      {
+        // Only the prescaler and PER
+        setPeriod_TIMER_TCC(_period);
+        
+        if (!SAMD_TCC->CTRLA.bit.ENABLE)
+        {
+          // Stopped by disableTimer() or at the end of a run limit. setPeriod_TIMER_TCC() only restarts the
+          // counter when it had to stop it for a new prescaler
+          SAMD_TCC->CTRLA.reg |= TCC_CTRLA_ENABLE;
+          while (SAMD_TCC->SYNCBUSY.bit.ENABLE == 1);
+        }
+        
+        setCallback(callback);
+        
+        // Also after detachInterrupt()
+        enableIRQ();
+      }
+      else
+      {
+        REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN(_gclkGenerator) | GCLK_CLKCTRL_ID(GCM_TCC0_TCC1));
+    
+        while ( GCLK->STATUS.bit.SYNCBUSY == 1 );
+      
+        TISR_LOGWARN3(F("SAMDTimerInterrupt: F_CPU (MHz) ="), F_CPU/1000000, F(", Timer clock (Hz) ="), _timerHz);
+        TISR_LOGWARN3(F("TCC_Timer::startTimer _Timer = 0x"), TISR_HEX(_SAMDTimer), F(", TCC0 = 0x"), TISR_HEX(TCC0));
+     
+        SAMD_TCC->CTRLA.reg &= ~TCC_CTRLA_ENABLE;   // Disable TC
+      
+        while (SAMD_TCC->SYNCBUSY.bit.ENABLE == 1); // wait for sync 
+      
+        SAMD_TCC->CTRLBCLR.reg = TCC_CTRLBCLR_ONESHOT;
+        while (SAMD_TCC->SYNCBUSY.bit.CTRLB == 1);
+            
+        setPeriod_TIMER_TCC(_period);
+
+        // Use match mode so that the timer counter resets when the count matches the compare register
+        SAMD_TCC->WAVE.reg |= TCC_WAVE_WAVEGEN_NFRQ;   // Set wave form configuration 
+      
+        while (SAMD_TCC->SYNCBUSY.bit.WAVE == 1); // wait for sync 
+
+        // Enable the compare interrupt
+        SAMD_TCC->INTENCLR.reg = TCC_INTENCLR_MASK;
+        SAMD_TCC->INTENSET.reg = 0;
+        SAMD_TCC->INTENSET.bit.OVF = 1;
+        SAMD_TCC->INTENSET.bit.MC0 = 1;
+
+        setCallback(callback);
+        
+        enableIRQ();
+
+        SAMD_TCC->CTRLA.reg |= TCC_CTRLA_ENABLE;
+      
+        while (SAMD_TCC->SYNCBUSY.bit.ENABLE == 1); // wait for sync
+        
+        initialized = true;
+      }
+
+      _lastPeriod     = _period;
+      _lastClockError = SAMD_clockErrorPpb;
+      _trimPeriod     = _period;
+      
+      SAMD_clockTimer[_timerNumber] = this;
+      
+      // PER only holds whole ticks of the corrected clock, the accumulator adds the rest
+      if (SAMD_clockErrorPpb != 0)
+        applyClockError();
+    }
+  
+    return true;
+  }
+  
+  void SAMDTimerInterrupt::setCallback(timerCallback callback)
+  {
+    // The handler must not see the new limit with the old callback. Masked until the enableIRQ() of the attach
+    NVIC_DisableIRQ(getIRQ());
+    
+    _callback = callback;
+    
+    if (_timerNumber == TIMER_TC3)
+    {
+      TC3_callback      = callback;
+      TC3_runsLeft      = _runLimit;
+      TC3_doneCallback  = _doneCallback;
+    }
+    else
+    {
+      TCC_callback      = callback;
+      TCC_runsLeft      = _runLimit;
+      TCC_doneCallback  = _doneCallback;
+    }
+    
+    // The limit applies to this attach only
+    _runLimit     = 0;
+    _doneCallback = NULL;
+  }
+  
+  uint32_t SAMDTimerInterrupt::getRemainingRuns()
+  {
+    return (_timerNumber == TIMER_TC3) ? TC3_runsLeft : TCC_runsLeft;
+  }
+  
+  double SAMDTimerInterrupt::getPeriod()
+  {
+    double ticks;
+    
+    if (_timerNumber == TIMER_TC3)
+    {
+      if (TC3_phaseStep != 0)
+        ticks = TC3_baseCompare + 1 + TC3_phaseStep / 4294967296.0;
+      else
+      {
+        // CC0 of the 16-bit mode, at offset 0x18
+        SAMD_TC3->READREQ.reg = TC_READREQ_RREQ | TC_READREQ_ADDR(0x18);
+        while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+        
+        ticks = SAMD_TC3->CC[0].reg + 1.0;
+      }
+    }
+    else
+    {
+      ticks = (TCC_phaseStep != 0) ? (TCC_basePeriod + 1 + TCC_phaseStep / 4294967296.0) : 
+                                     (SAMD_TCC->PER.reg + 1.0);
+    }
+    
+    return ticks * _prescaler * 1000000.0 / clockHz();
+  }
+  
+  double SAMDTimerInterrupt::getMaxPeriod()
+  {
+    // 16-bit CC0 (TC3) or 24-bit PER (TCC) at DIV1024
+    return ( (_timerNumber == TIMER_TC3) ? 65535.0 : 16777215.0 ) * 1024 * 1000000.0 / clockHz();
+  }
+  
+  // frequency (in hertz) and duration (in milliseconds). Duration = 0 or not specified => run indefinitely
+  // No params and duration now. To be addes in the future by adding similar functions here or to SAMD-hal-timer.c
+  bool SAMDTimerInterrupt::setFrequency(const float& frequency, timerCallback callback)
+  {
+    float _period =  (1000000.0f / frequency);
+    TISR_LOGDEBUG3(F("_period ="), _period, F(", frequency ="), frequency);
+    return _setPeriod(_period, callback);
+  }
+
+  bool SAMDTimerInterrupt::setFrequencyExact(const float& frequency, timerCallback callback)
+  {
+    if (frequency <= 0)
+      return false;
+      
+    // Same prescaler as setFrequency() selects. Checked before attaching, so a failure leaves the timer untouched
+    uint16_t prescaler  = SAMD_prescalerDivider[SAMD_periodPrescalerIndex((1000000.0f / frequency) * ((float) _timerHz / TIMER_HZ))];
+
+    // Ideal period in (prescaled) timer ticks, split into whole ticks and a 32-bit binary fraction
+    double   ticks      = clockHz() / prescaler / frequency;
+    uint32_t wholeTicks = (uint32_t) ticks;
+    uint32_t phaseStep  = (uint32_t) ((ticks - wholeTicks) * 4294967296.0);
+    
+    // N + 1 must still fit the counter: 16-bit TC3, 24-bit TCC0
+    uint32_t maxTicks   = (_timerNumber == TIMER_TC3) ? 0xFFFF : 0xFFFFFF;
+
+    if ( (wholeTicks < 2) || (wholeTicks > maxTicks) )
+      return false;
+      
+    if (!setFrequency(frequency, callback))
+      return false;
+
+    noInterrupts();
+    
+    if (_timerNumber == TIMER_TC3)
+    {
+      TC3_baseCompare = wholeTicks - 1;
+      TC3_phaseAcc    = 0;
+      TC3_phaseStep   = phaseStep;
+    }
+    else
+    {
+      TCC_basePeriod  = wholeTicks - 1;
+      TCC_phaseAcc    = 0;
+      TCC_phaseStep   = phaseStep;
+    }
+    
+    interrupts();
+    
+    // The ISR now moves CC / PER every period
+    _lastPeriod     = 0;
+    _trimPeriod     = 1000000.0 / frequency;
+
+    _frequencyError = (float) ( clockHz() / _prescaler / (wholeTicks + phaseStep / 4294967296.0) - frequency );
+
+    TISR_LOGDEBUG3(F("setFrequencyExact: N ="), wholeTicks, F(", phaseStep ="), phaseStep);
+    TISR_LOGDEBUG1(F("Frequency error (Hz) ="), _frequencyError);
+
+    return true;
+  }
+  
+  bool SAMDTimerInterrupt::applyClockError()
+  {
+    if ( !initialized || (_trimPeriod == 0) || (_prescaler == 0) || (_asyncState != SAMD_ASYNC_IDLE) )
+      return false;
+      
+    // Same split as setFrequencyExact(), at the running prescaler
+    double   ticks      = clockHz() / _prescaler * (_trimPeriod / 1000000.0);
+    uint32_t wholeTicks = (uint32_t) ticks;
+    uint32_t phaseStep  = (uint32_t) ((ticks - wholeTicks) * 4294967296.0);
+    uint32_t maxTicks   = (_timerNumber == TIMER_TC3) ? 0xFFFF : 0xFFFFFF;
+    
+    if ( (wholeTicks < 2) || (wholeTicks > maxTicks) )
+      return false;
+      
+    // Also called from interrupt handlers, e.g. by SAMDTimerDiscipline
+    uint32_t primask = __get_PRIMASK();
+    
+    __disable_irq();
+    
+    if (_timerNumber == TIMER_TC3)
+    {
+      // No CCBUF on the SAMD21 TC, the ISR applies it at the next match, then runs the accumulator
+      TC3_baseCompare     = wholeTicks - 1;
+      TC3_phaseStep       = phaseStep;
+      TC3_pendingCompare  = wholeTicks - 1;
+    }
+    else
+    {
+      // Latched by the hardware at the next overflow, so the running period completes
+      TCC_basePeriod      = wholeTicks - 1;
+      TCC_phaseStep       = phaseStep;
+      SAMD_TCC->PERB.reg  = wholeTicks - 1;
+    }
+    
+    __set_PRIMASK(primask);
+    
+    _lastClockError = SAMD_clockErrorPpb;
+    
+    TISR_LOGDEBUG3(F("applyClockError: N ="), wholeTicks, F(", phaseStep ="), phaseStep);
+    
+    return true;
+  }
+
+  bool SAMDTimerInterrupt::setPeriodBuffered(const float& period)
+  {
+    if ( (_callback == NULL) || (_prescaler == 0) )
+      return false;
+
+    uint32_t _compareValue  = (uint32_t) (clockHz() / (_prescaler / (period / 1000000.0))) - 1;
+    uint32_t maxCompare     = (_timerNumber == TIMER_TC3) ? 0xFFFF : 0xFFFFFF;
+
+    if ( (_compareValue < 1) || (_compareValue > maxCompare) )
+      return false;
+
+    if (_timerNumber == TIMER_TC3)
+    {
+      // The ISR would otherwise overwrite CC on its next run
+      TC3_phaseStep       = 0;
+      TC3_pendingCompare  = _compareValue;
+    }
+    else if (_timerNumber == TIMER_TCC)
+    {
+      TCC_phaseStep = 0;
+      
+      SAMD_TCC->PERB.reg = _compareValue;
+    }
+    
+    _lastPeriod = 0;
+    _trimPeriod = period;
+    
+    TISR_LOGDEBUG3(F("setPeriodBuffered: period ="), period, F(", _compareValue ="), _compareValue);
+
+    return true;
+  }
+
+  bool SAMDTimerInterrupt::setPeriodAsync(const float& period)
+  {
+    if ( !initialized || (_asyncState != SAMD_ASYNC_IDLE) || (period <= 0) )
+      return false;
+      
+    uint8_t  prescalerIndex = SAMD_periodPrescalerIndex(period * ((float) _timerHz / TIMER_HZ));
+    uint32_t _compareValue  = (uint32_t) (clockHz() / (SAMD_prescalerDivider[prescalerIndex] / (period / 1000000.0))) - 1;
+    uint32_t maxCompare     = (_timerNumber == TIMER_TC3) ? 0xFFFF : 0xFFFFFF;
+    
+    if ( (_compareValue < 1) || (_compareValue > maxCompare) )
+      return false;
+      
+    _prescaler  = SAMD_prescalerDivider[prescalerIndex];
+    _lastPeriod = 0;
+    _trimPeriod = period;
+    
+    if (_timerNumber == TIMER_TC3)
+    {
+      TC3_phaseStep   = 0;
+      
+      uint16_t ctrla  = SAMD_TC3->CTRLA.reg;
+      
+      if ( (ctrla & TC_CTRLA_ENABLE) && ((ctrla & TC_CTRLA_PRESCALER_Msk) == TC_CTRLA_PRESCALER(prescalerIndex)) )
+      {
+        // No register write at all, the ISR applies it at the next match
+        TC3_pendingCompare = _compareValue;
+        
+        return true;
+      }
+    }
+    else
+    {
+      TCC_phaseStep   = 0;
+      
+      uint32_t ctrla  = SAMD_TCC->CTRLA.reg;
+      
+      if ( (ctrla & TCC_CTRLA_ENABLE) && ((ctrla & TCC_CTRLA_PRESCALER_Msk) == TCC_CTRLA_PRESCALER(prescalerIndex)) )
+      {
+        // Latched by the hardware at the next overflow
+        SAMD_TCC->PERB.reg = _compareValue;
+        
+        return true;
+      }
+    }
+    
+    _asyncPrescaler = prescalerIndex;
+    _asyncCompare   = _compareValue;
+    _asyncState     = SAMD_ASYNC_DISABLE;
+    
+    pollPeriodAsync();
+    
+    return true;
+  }
+  
+  bool SAMDTimerInterrupt::getLatencyStats(SAMDLatencyStats& stats)
+  {
+#if (USING_LATENCY_PROBE)
+    float cyclesPerTick = (float) F_CPU * _prescaler / _timerHz;
+    
+    if (_timerNumber == TIMER_TC3)
+      return SAMD_readLatency(TC3_latency, cyclesPerTick, stats);
+    else
+      return SAMD_readLatency(TCC_latency, cyclesPerTick, stats);
+#else
+    (void) stats;
+    
+    return false;
+#endif
+  }
+  
+  void SAMDTimerInterrupt::resetLatencyStats()
+  {
+#if (USING_LATENCY_PROBE)
+    SAMD_resetLatency( (_timerNumber == TIMER_TC3) ? TC3_latency : TCC_latency );
+#endif
+  }
+  
+  bool SAMDTimerInterrupt::pollPeriodAsync()
+  {
+    while (_asyncState != SAMD_ASYNC_IDLE)
+    {
+      if (_timerNumber == TIMER_TC3)
+      {
+        // A write during synchronization would stall the bus until it completes, so write only when idle
+        if (SAMD_TC3->STATUS.bit.SYNCBUSY)
+          return false;
+          
+        switch (_asyncState)
+        {
+          case SAMD_ASYNC_DISABLE:
+            SAMD_TC3->CTRLA.reg &= ~TC_CTRLA_ENABLE;
+            break;
+            
+          case SAMD_ASYNC_PRESCALER:
+            SAMD_TC3->CTRLA.reg = (SAMD_TC3->CTRLA.reg & ~TC_CTRLA_PRESCALER_Msk) | TC_CTRLA_PRESCALER(_asyncPrescaler);
+            break;
+            
+          case SAMD_ASYNC_COMPARE:
+            SAMD_TC3->CC[0].reg = _asyncCompare;
+            break;
+            
+          case SAMD_ASYNC_COUNT:
+            SAMD_TC3->COUNT.reg = 0;
+            break;
+            
+          case SAMD_ASYNC_ENABLE:
+            SAMD_TC3->CTRLA.reg |= TC_CTRLA_ENABLE;
+            break;
+            
+          default:
+            break;
+        }
+      }
+      else
+      {
+        if (SAMD_TCC->SYNCBUSY.reg != 0)
+          return false;
+          
+        switch (_asyncState)
+        {
+          case SAMD_ASYNC_DISABLE:
+            SAMD_TCC->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+            break;
+            
+          case SAMD_ASYNC_PRESCALER:
+            // CTRLA isn't synchronized, and PER / COUNT synchronize in parallel
+            SAMD_TCC->CTRLA.reg = (SAMD_TCC->CTRLA.reg & ~TCC_CTRLA_PRESCALER_Msk) | TCC_CTRLA_PRESCALER(_asyncPrescaler);
+            SAMD_TCC->PER.reg   = _asyncCompare;
+            SAMD_TCC->COUNT.reg = 0;
+            _asyncState         = SAMD_ASYNC_COUNT;
+            break;
+            
+          case SAMD_ASYNC_ENABLE:
+            SAMD_TCC->CTRLA.reg |= TCC_CTRLA_ENABLE;
+            break;
+            
+          default:
+            break;
+        }
+      }
+      
+      _asyncState = (_asyncState == SAMD_ASYNC_FINISH) ? SAMD_ASYNC_IDLE : (SAMDAsyncState) (_asyncState + 1);
+    }
+    
+    return true;
+  }
+  
+  bool SAMDTimerInterrupt::configureClockGenerator(const uint8_t& generator, const uint8_t& source, const uint32_t& sourceHz, 
+                                                   const uint16_t& divider)
+  {
+    if ( (generator >= GCLK_GEN_NUM) || (divider == 0) )
+      return false;
+      
+    // generator 1 has a 16-bit divider, the others 8-bit
+    if ( (generator != 1) && (divider > 0xFF) )
+      return false;
+      
+    GCLK->GENDIV.reg = GCLK_GENDIV_ID(generator) | GCLK_GENDIV_DIV(divider);
+    while ( GCLK->STATUS.bit.SYNCBUSY);
+    
+    GCLK->GENCTRL.reg = GCLK_GENCTRL_ID(generator) | GCLK_GENCTRL_SRC(source) | GCLK_GENCTRL_IDC | GCLK_GENCTRL_GENEN;
+    while ( GCLK->STATUS.bit.SYNCBUSY);
+    
+    TISR_LOGWARN3(F("configureClockGenerator: GCLK"), generator, F(", Hz ="), sourceHz / divider);
+
+    return setClockSource(generator, sourceHz / divider);
+  }
+  
+  bool SAMDTimerInterrupt::beginCompareChannels(const float& maxPeriod)
+  {
+    if (_timerNumber == TIMER_TC3)
+    {
+      uint8_t prescalerIndex = SAMD_selectPrescaler(maxPeriod, _timerHz, 0xFFFF);
+      
+      _prescaler = SAMD_prescalerDivider[prescalerIndex];
+      
+      REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN(_gclkGenerator) | GCLK_CLKCTRL_ID (GCM_TCC2_TC3));
+      while ( GCLK->STATUS.bit.SYNCBUSY);
+      
+      SAMD_TC3->CTRLA.reg &= ~TC_CTRLA_ENABLE;
+      while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+      
+      // 16-bit counter running over its full range
+      SAMD_TC3->CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_WAVEGEN_NFRQ | TC_CTRLA_PRESCALER(prescalerIndex);
+      while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+      
+      SAMD_TC3->CTRLBCLR.reg = TC_CTRLBCLR_ONESHOT;
+      while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+      
+      SAMD_TC3->COUNT.reg = 0;
+      while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+      
+      SAMD_TC3->INTENCLR.reg  = TC_INTENCLR_MASK;
+      SAMD_TC3->INTFLAG.reg   = TC_INTFLAG_MASK;
+      
+      TC3_phaseStep       = 0;
+      TC3_pendingCompare  = -1;
+      TC3_channelMask     = 0;
+      
+      // The periodic fast path assumes MFRQ
+      initialized         = false;
+      
+      enableIRQ();
+    }
+    else if (_timerNumber == TIMER_TCC)
+    {
+      uint8_t prescalerIndex = SAMD_selectPrescaler(maxPeriod, _timerHz, 0xFFFFFF);
+      
+      _prescaler = SAMD_prescalerDivider[prescalerIndex];
+      
+      REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN(_gclkGenerator) | GCLK_CLKCTRL_ID(GCM_TCC0_TCC1));
+      while ( GCLK->STATUS.bit.SYNCBUSY == 1 );
+      
+      SAMD_TCC->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+      while (SAMD_TCC->SYNCBUSY.bit.ENABLE == 1);
+      
+      SAMD_TCC->CTRLA.reg = TCC_CTRLA_PRESCALER(prescalerIndex);
+      
+      SAMD_TCC->CTRLBCLR.reg = TCC_CTRLBCLR_ONESHOT;
+      while (SAMD_TCC->SYNCBUSY.bit.CTRLB == 1);
+      
+      // 24-bit counter running over its full range
+      SAMD_TCC->WAVE.reg = TCC_WAVE_WAVEGEN_NFRQ;
+      while (SAMD_TCC->SYNCBUSY.bit.WAVE == 1);
+      
+      SAMD_TCC->PER.reg = 0xFFFFFF;
+      while (SAMD_TCC->SYNCBUSY.bit.PER == 1);
+      
+      SAMD_TCC->COUNT.reg = 0;
+      while (SAMD_TCC->SYNCBUSY.bit.COUNT == 1);
+      
+      SAMD_TCC->INTENCLR.reg  = TCC_INTENCLR_MASK;
+      SAMD_TCC->INTFLAG.reg   = TCC_INTFLAG_MASK;
+      
+      TCC_phaseStep     = 0;
+      TCC_channelMask   = 0;
+      
+      enableIRQ();
+    }
+    else
+      return false;
+      
+    _callback         = NULL;
+    _compareChannels  = true;
+    _oneShotDelay     = 0;
+    _trimPeriod       = 0;
+    
+    TISR_LOGDEBUG3(F("beginCompareChannels: maxPeriod ="), maxPeriod, F(", _prescaler ="), _prescaler);
+    
+    return true;
+  }
+  
+  bool SAMDTimerInterrupt::attachCompareInterrupt(const uint8_t& channel, const float& offset, const float& period, 
+                                                  timerCallback callback)
+  {
+    uint8_t   numChannels = (_timerNumber == TIMER_TC3) ? SAMD_TC3_NUM_CHANNELS : SAMD_TCC_NUM_CHANNELS;
+    uint32_t  maxTicks    = (_timerNumber == TIMER_TC3) ? 0xFFFF : 0xFFFFFF;
+    
+    if ( !_compareChannels || (channel >= numChannels) || (callback == NULL) )
+      return false;
+      
+    float    ticksPerUs   = clockHz() / 1000000.0f / _prescaler;
+    uint32_t periodTicks  = (uint32_t) (period * ticksPerUs + 0.5f);
+    uint32_t offsetTicks  = (uint32_t) (offset * ticksPerUs + 0.5f);
+    
+    if ( (periodTicks == 0) || (periodTicks > maxTicks) || (offsetTicks > maxTicks) )
+      return false;
+    
+    // Counter is still at 0 before startCompareChannels(). The TCC ignores READSYNC while disabled, don't wait on it
+    bool     enabled  = (_timerNumber == TIMER_TC3) ? SAMD_TC3->CTRLA.bit.ENABLE : SAMD_TCC->CTRLA.bit.ENABLE;
+    uint32_t origin   = enabled ? readCount() : 0;
+    
+    noInterrupts();
+    
+    if (_timerNumber == TIMER_TC3)
+    {
+      TC3_channelCallback[channel]  = callback;
+      TC3_channelStep[channel]      = periodTicks;
+      TC3_channelNext[channel]      = origin + offsetTicks;
+      
+      SAMD_TC3->CC[channel].reg     = TC3_channelNext[channel];
+      while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+      
+      SAMD_TC3->INTFLAG.reg         = TC_INTFLAG_MC(1 << channel);
+      TC3_channelMask              |= (1 << channel);
+      SAMD_TC3->INTENSET.reg        = TC_INTENSET_MC(1 << channel);
+    }
+    else
+    {
+      TCC_channelCallback[channel]  = callback;
+      TCC_channelStep[channel]      = periodTicks;
+      TCC_channelNext[channel]      = (origin + offsetTicks) & 0xFFFFFF;
+      
+      SAMD_TCC->CC[channel].reg     = TCC_channelNext[channel];
+      while (SAMD_TCC->SYNCBUSY.reg & (TCC_SYNCBUSY_CC0 << channel));
+      
+      SAMD_TCC->INTFLAG.reg         = TCC_INTFLAG_MC(1 << channel);
+      TCC_channelMask              |= (1 << channel);
+      SAMD_TCC->INTENSET.reg        = TCC_INTENSET_MC(1 << channel);
+    }
+    
+    interrupts();
+    
+    TISR_LOGDEBUG3(F("attachCompareInterrupt: channel ="), channel, F(", periodTicks ="), periodTicks);
+    
+    return true;
+  }
+  
+  void SAMDTimerInterrupt::detachCompareInterrupt(const uint8_t& channel)
+  {
+    noInterrupts();
+    
+    if ( (_timerNumber == TIMER_TC3) && (channel < SAMD_TC3_NUM_CHANNELS) )
+    {
+      SAMD_TC3->INTENCLR.reg  = TC_INTENCLR_MC(1 << channel);
+      TC3_channelMask        &= ~(1 << channel);
+    }
+    else if ( (_timerNumber == TIMER_TCC) && (channel < SAMD_TCC_NUM_CHANNELS) )
+    {
+      SAMD_TCC->INTENCLR.reg  = TCC_INTENCLR_MC(1 << channel);
+      TCC_channelMask        &= ~(1 << channel);
+    }
+    
+    interrupts();
+  }
+  
+  void SAMDTimerInterrupt::startCompareChannels()
+  {
+    enableTimer();
+  }
+  
+  bool SAMDTimerInterrupt::fireOnceAfter(const float& delay, timerCallback callback)
+  {
+    if ( (delay <= 0) || (callback == NULL) )
+      return false;
+      
+    if (delay == _oneShotDelay)
+    {
+      // Already armed for this delay, only restart it
+      _callback = callback;
+      
+      if (_timerNumber == TIMER_TC3)
+        TC3_callback = callback;
+      else
+        TCC_callback = callback;
+      
+      retriggerOneShot();
+      
+      return true;
+    }
+    
+    uint32_t  maxTicks        = (_timerNumber == TIMER_TC3) ? 0xFFFF : 0xFFFFFF;
+    uint8_t   prescalerIndex  = SAMD_selectPrescaler(delay, _timerHz, maxTicks);
+    uint32_t  ticks           = (uint32_t) (delay * (clockHz() / 1000000.0f) / SAMD_prescalerDivider[prescalerIndex] + 0.5f);
+    
+    if ( (ticks < 2) || (ticks > maxTicks) )
+      return false;
+    
+    if (_timerNumber == TIMER_TC3)
+    {
+      REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN(_gclkGenerator) | GCLK_CLKCTRL_ID (GCM_TCC2_TC3));
+      while ( GCLK->STATUS.bit.SYNCBUSY);
+      
+      SAMD_TC3->CTRLA.reg &= ~TC_CTRLA_ENABLE;
+      while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+      
+      // MC0 fires when the count reaches CC0, 'ticks' after the start, and the counter stops at the following wrap
+      SAMD_TC3->CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_WAVEGEN_MFRQ | TC_CTRLA_PRESCALER(prescalerIndex);
+      while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+      
+      SAMD_TC3->CTRLBSET.reg = TC_CTRLBSET_ONESHOT;
+      while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+      
+      SAMD_TC3->CC[0].reg = ticks;
+      while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+      
+      SAMD_TC3->COUNT.reg = 0;
+      while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+      
+      SAMD_TC3->INTENCLR.reg  = TC_INTENCLR_MASK;
+      SAMD_TC3->INTFLAG.reg   = TC_INTFLAG_MASK;
+      SAMD_TC3->INTENSET.reg  = TC_INTENSET_MC0;
+      
+      TC3_phaseStep       = 0;
+      TC3_pendingCompare  = -1;
+      TC3_channelMask     = 0;
+      TC3_runsLeft        = 0;
+      TC3_callback        = callback;
+      
+      // The periodic fast path assumes MFRQ without ONESHOT
+      initialized         = false;
+      
+      enableIRQ();
+      
+      // Enabling starts the first shot
+      SAMD_TC3->CTRLA.reg |= TC_CTRLA_ENABLE;
+      while (SAMD_TC3->STATUS.bit.SYNCBUSY);
+    }
+    else if (_timerNumber == TIMER_TCC)
+    {
+      REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN(_gclkGenerator) | GCLK_CLKCTRL_ID(GCM_TCC0_TCC1));
+      while ( GCLK->STATUS.bit.SYNCBUSY == 1 );
+      
+      SAMD_TCC->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+      while (SAMD_TCC->SYNCBUSY.bit.ENABLE == 1);
+      
+      SAMD_TCC->CTRLA.reg = TCC_CTRLA_PRESCALER(prescalerIndex);
+      
+      SAMD_TCC->CTRLBSET.reg = TCC_CTRLBSET_ONESHOT;
+      while (SAMD_TCC->SYNCBUSY.bit.CTRLB == 1);
+      
+      // OVF fires 'ticks' after the start, when the count wraps from PER, and the counter stops there
+      SAMD_TCC->WAVE.reg = TCC_WAVE_WAVEGEN_NFRQ;
+      while (SAMD_TCC->SYNCBUSY.bit.WAVE == 1);
+      
+      SAMD_TCC->PER.reg = ticks - 1;
+      while (SAMD_TCC->SYNCBUSY.bit.PER == 1);
+      
+      SAMD_TCC->COUNT.reg = 0;
+      while (SAMD_TCC->SYNCBUSY.bit.COUNT == 1);
+      
+      SAMD_TCC->INTENCLR.reg  = TCC_INTENCLR_MASK;
+      SAMD_TCC->INTFLAG.reg   = TCC_INTFLAG_MASK;
+      SAMD_TCC->INTENSET.reg  = TCC_INTENSET_OVF;
+      
+      TCC_phaseStep   = 0;
+      TCC_channelMask = 0;
+      TCC_runsLeft    = 0;
+      TCC_callback    = callback;
+      
+      enableIRQ();
+      
+      // Enabling starts the first shot
+      SAMD_TCC->CTRLA.reg |= TCC_CTRLA_ENABLE;
+      while (SAMD_TCC->SYNCBUSY.bit.ENABLE == 1);
+    }
+    else
+      return false;
+    
+    _prescaler        = SAMD_prescalerDivider[prescalerIndex];
+    _compareChannels  = false;
+    _oneShotDelay     = delay;
+    _trimPeriod       = 0;
+    _callback         = callback;
+    
+    TISR_LOGDEBUG3(F("fireOnceAfter: delay ="), delay, F(", ticks ="), ticks);
+    
+    return true;
+  }
+  
+  // Keeps TC3_callback / TCC_callback valid while the timer runs as a trigger source only
+  void SAMD_triggerOnlyCallback()
+  {
+  }
+  
+  bool SAMDTimerInterrupt::setTriggerPeriod(const float& period)
+  {
+    if (!_setPeriod(period, SAMD_triggerOnlyCallback))
+      return false;
+      
+    // Overflow still raises the DMA / event triggers, the CPU is never interrupted. So no ISR to run the accumulator
+    if (_timerNumber == TIMER_TC3)
+    {
+      SAMD_TC3->INTENCLR.reg  = TC_INTENCLR_MASK;
+      TC3_phaseStep           = 0;
+      TC3_pendingCompare      = -1;
+    }
+    else
+    {
+      SAMD_TCC->INTENCLR.reg  = TCC_INTENCLR_MASK;
+      TCC_phaseStep           = 0;
+    }
+    
+    // The next attach must enable the interrupts again
+    initialized = false;
+    
+    return true;
+  }
+  
+  void SAMDTimerInterrupt::enableEventOutput()
+  {
+    if (_timerNumber == TIMER_TC3)
+    {
+      SAMD_TC3->EVCTRL.reg |= TC_EVCTRL_OVFEO;
+    }
+    else if (_timerNumber == TIMER_TCC)
+    {
+      // TCC EVCTRL is enable-protected
+      bool wasEnabled = SAMD_TCC->CTRLA.bit.ENABLE;
+      
+      SAMD_TCC->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+      while (SAMD_TCC->SYNCBUSY.bit.ENABLE == 1);
+      
+      SAMD_TCC->EVCTRL.reg |= TCC_EVCTRL_OVFEO;
+      
+      if (wasEnabled)
+      {
+        SAMD_TCC->CTRLA.reg |= TCC_CTRLA_ENABLE;
+        while (SAMD_TCC->SYNCBUSY.bit.ENABLE == 1);
+      }
+    }
+  }
+
+  bool SAMDTimerInterrupt::isUpdatePending()
+  {
+    if (_timerNumber == TIMER_TC3)
+    {
+      return (TC3_pendingCompare >= 0);
+    }
+    else if (_timerNumber == TIMER_TCC)
+    {
+      return SAMD_TCC->STATUS.bit.PERBV;
+    }
+    
+    return false;
+  }
+
+#endif    // #if (TIMER_INTERRUPT_USING_SAMD51)
+
+////////////////////////////////////////////////////
+
+volatile int32_t SAMD_clockErrorPpb = 0;
+
+void SAMD_setClockError(const int32_t& ppb)
+{
+  if (ppb == SAMD_clockErrorPpb)
+    return;
+    
+  SAMD_clockErrorPpb = ppb;
+  
+  // Running periodic timers follow at once, without waiting for their next attach
+  for (uint8_t timer = 0; timer < MAX_TIMER; timer++)
+  {
+    if (SAMD_clockTimer[timer])
+      SAMD_clockTimer[timer]->applyClockError();
+  }
+}
+
+int32_t SAMD_getClockError()
+{
+  return SAMD_clockErrorPpb;
+}
+
+////////////////////////////////////////////////////
+
+#if (TIMERINTERRUPT_DEFERRED_LOG)
+
+static_assert((SAMD_LOG_BUFFER_SIZE & (SAMD_LOG_BUFFER_SIZE - 1)) == 0, "SAMD_LOG_BUFFER_SIZE must be a power of 2");
+
+typedef struct
+{
+  uint32_t        args[SAMD_LOG_MAX_ARGS];
+  uint8_t         types[SAMD_LOG_MAX_ARGS];
+  bool            line;
+  volatile bool   ready;      // set last by the writer, cleared by SAMD_flushLog()
+} SAMDLogRecord;
+
+SAMDLogRecord     SAMD_logRing[SAMD_LOG_BUFFER_SIZE];
+
+// Free-running indexes. Writers reserve a record by incrementing SAMD_logHead, only SAMD_flushLog() moves SAMD_logTail
+volatile uint32_t SAMD_logHead    = 0;
+volatile uint32_t SAMD_logTail    = 0;
+volatile uint32_t SAMD_logDropped = 0;
+
+// Reserve the next record. Writers preempting each other, from loop() or ISRs of any priority, get distinct records
+static bool SAMD_logReserve(uint32_t& index)
+{
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  do
+  {
+    index = __LDREXW(&SAMD_logHead);
+    
+    if (index - SAMD_logTail >= SAMD_LOG_BUFFER_SIZE)
+    {
+      __CLREX();
+      
+      uint32_t dropped;
+      
+      do
+      {
+        dropped = __LDREXW(&SAMD_logDropped);
+      } while (__STREXW(dropped + 1, &SAMD_logDropped));
+      
+      return false;
+    }
+  } while (__STREXW(index + 1, &SAMD_logHead));
+  
+  return true;
+  
+#else
+
+  // No LDREX / STREX on the Cortex-M0+: mask the interrupts for the few cycles of the index update only
+  uint32_t primask  = __get_PRIMASK();
+  
+  __disable_irq();
+  
+  index = SAMD_logHead;
+  
+  bool full = (index - SAMD_logTail >= SAMD_LOG_BUFFER_SIZE);
+  
+  if (full)
+    SAMD_logDropped++;
+  else
+    SAMD_logHead = index + 1;
+    
+  __set_PRIMASK(primask);
+  
+  return !full;
+  
+#endif
+}
+
+bool SAMD_logWrite(const bool& line, const SAMDLogArg& a, const SAMDLogArg& b, const SAMDLogArg& c, const SAMDLogArg& d)
+{
+  uint32_t index;
+  
+  if (!SAMD_logReserve(index))
+    return false;
+    
+  SAMDLogRecord& record = SAMD_logRing[index & (SAMD_LOG_BUFFER_SIZE - 1)];
+  
+  record.args[0]  = a.value;  record.types[0] = a.type;
+  record.args[1]  = b.value;  record.types[1] = b.type;
+  record.args[2]  = c.value;  record.types[2] = c.type;
+  record.args[3]  = d.value;  record.types[3] = d.type;
+  record.line     = line;
+  
+  // Contents complete before the reader can see the record
+  __DMB();
+  
+  record.ready    = true;
+  
+  return true;
+}
+
+static void SAMD_printLogArg(const uint32_t& value, const uint8_t& type)
+{
+  switch (type)
+  {
+    case SAMD_LOG_FSTRING:
+      TISR_DBG_PORT.print((const __FlashStringHelper*) value);
+      break;
+      
+    case SAMD_LOG_STRING:
+      TISR_DBG_PORT.print((const char*) value);
+      break;
+      
+    case SAMD_LOG_CHAR:
+      TISR_DBG_PORT.print((char) value);
+      break;
+      
+    case SAMD_LOG_INT:
+      TISR_DBG_PORT.print((int32_t) value);
+      break;
+      
+    case SAMD_LOG_UINT:
+      TISR_DBG_PORT.print(value);
+      break;
+      
+    case SAMD_LOG_FLOAT:
+    {
+      float x;
+      
+      memcpy(&x, &value, sizeof(float));
+      TISR_DBG_PORT.print(x);
+      break;
+    }
+      
+    case SAMD_LOG_HEX:
+      TISR_DBG_PORT.print(value, HEX);
+      break;
+      
+    default:
+      break;
+  }
+}
+
+uint16_t SAMD_flushLog()
+{
+  uint16_t printed = 0;
+  
+  while (SAMD_logTail != SAMD_logHead)
+  {
+    SAMDLogRecord& record = SAMD_logRing[SAMD_logTail & (SAMD_LOG_BUFFER_SIZE - 1)];
+    
+    // Reserved by a writer which was preempted before completing it. Keep the order, print it next time
+    if (!record.ready)
+      break;
+      
+    __DMB();
+    
+    if (record.line)
+      TISR_DBG_PORT.print(F("[TISR] "));
+      
+    for (uint8_t i = 0; (i < SAMD_LOG_MAX_ARGS) && (record.types[i] != SAMD_LOG_NONE); i++)
+    {
+      if (i > 0)
+        TISR_DBG_PORT.print(' ');
+        
+      SAMD_printLogArg(record.args[i], record.types[i]);
+    }
+    
+    if (record.line)
+      TISR_DBG_PORT.println();
+      
+    record.ready = false;
+    
+    // Record free for the writers only once read
+    __DMB();
+    
+    SAMD_logTail = SAMD_logTail + 1;
+    printed++;
+  }
+  
+  return printed;
+}
+
+#else
+
+bool SAMD_logWrite(const bool& line, const SAMDLogArg& a, const SAMDLogArg& b, const SAMDLogArg& c, const SAMDLogArg& d)
+{
+  (void) line; (void) a; (void) b; (void) c; (void) d;
+  
+  return false;
+}
+
+uint16_t SAMD_flushLog()
+{
+  return 0;
+}
+
+volatile uint32_t SAMD_logDropped = 0;
+
+#endif    // #if (TIMERINTERRUPT_DEFERRED_LOG)
+
+uint32_t SAMD_getLogDropped()
+{
+  return SAMD_logDropped;
+}
+
+////////////////////////////////////////////////////
+
+// Context callbacks, indexed by SAMDTimerNumber. The handlers are unchanged: they call the fixed dispatcher of their
+// timer through TC3_callback / TCC_callback, which forwards the context
+SAMDTimerDispatch SAMD_timerDispatch[MAX_TIMER];
+
+SAMD_TIMER_RAMFUNC static void SAMD_dispatchTC3()
+{
+  (*SAMD_timerDispatch[TIMER_TC3].callback)(SAMD_timerDispatch[TIMER_TC3].param);
+}
+
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  static const timerCallback SAMD_timerDispatcher[MAX_TIMER] = { SAMD_dispatchTC3 };
+  
+#else
+
+  SAMD_TIMER_RAMFUNC static void SAMD_dispatchTCC()
+  {
+    (*SAMD_timerDispatch[TIMER_TCC].callback)(SAMD_timerDispatch[TIMER_TCC].param);
+  }
+
+  static const timerCallback SAMD_timerDispatcher[MAX_TIMER] = { SAMD_dispatchTC3, SAMD_dispatchTCC };
+  
+#endif
+
+timerCallback SAMDTimerInterrupt::setDispatch(timerCallback_p callback, void* param)
+{
+  // The handler may be running with the previous pair
+  noInterrupts();
+  
+  SAMD_timerDispatch[_timerNumber].callback = callback;
+  SAMD_timerDispatch[_timerNumber].param    = param;
+  
+  interrupts();
+  
+  return SAMD_timerDispatcher[_timerNumber];
+}
+
+////////////////////////////////////////////////////
+
+// 16 core exceptions, then the peripheral IRQs
+#define SAMD_VECTOR_TABLE_SIZE      (16 + PERIPH_COUNT_IRQn)
+
+bool SAMD_useRAMVectorTable()
+{
+  // VTOR needs the table aligned to its size, rounded up to a power of 2
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  static uint32_t ramVectors[SAMD_VECTOR_TABLE_SIZE] __attribute__((aligned(1024)));
+#else
+  static uint32_t ramVectors[SAMD_VECTOR_TABLE_SIZE] __attribute__((aligned(256)));
+#endif
+
+  if (SCB->VTOR == (uint32_t) ramVectors)
+    return true;
+    
+  // The bootloader may have moved the table already, so copy from wherever it is now
+  const uint32_t* vectors = (const uint32_t*) SCB->VTOR;
+  
+  noInterrupts();
+  
+  for (uint16_t i = 0; i < SAMD_VECTOR_TABLE_SIZE; i++)
+  {
+    ramVectors[i] = vectors[i];
+  }
+  
+  SCB->VTOR = (uint32_t) ramVectors;
+  __DSB();
+  
+  interrupts();
+  
+  TISR_LOGDEBUG1(F("SAMD_useRAMVectorTable: VTOR ="), SCB->VTOR);
+  
+  return true;
+}
 
 #endif    // SAMD_TIMERINTERRUPT_IMPL_H
@@ -59,7 +59,7 @@ void SAMD_ISR_Timer::init()
   numTimers = 0;
 }
 
-void SAMD_ISR_Timer::run() 
+SAMD_TIMER_RAMFUNC void SAMD_ISR_Timer::run()
 {
   uint8_t i;
   unsigned long current_millis;
@@ -62,6 +62,15 @@
 
 #include "TimerInterrupt_Generic_Debug.h"
 
+// Same as in SAMDTimerInterrupt.hpp, run() goes to SRAM when USING_RAMFUNC_HANDLERS is true
+#ifndef SAMD_TIMER_RAMFUNC
+  #if (defined(USING_RAMFUNC_HANDLERS) && USING_RAMFUNC_HANDLERS)
+    #define SAMD_TIMER_RAMFUNC      __attribute__((section(".ramfunc"), noinline))
+  #else
+    #define SAMD_TIMER_RAMFUNC
+  #endif
+#endif
+
 #include <stddef.h>
 
 #include <inttypes.h>
@@ -94,7 +103,7 @@ class SAMD_ISR_Timer
     void init();
 
     // this function must be called inside loop()
-    void run();
+    SAMD_TIMER_RAMFUNC void run();
 
     // Timer will call function 'f' every 'd' milliseconds forever
     // returns the timer number (numTimer) on success or
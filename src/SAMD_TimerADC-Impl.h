@@ -0,0 +1,157 @@
+/****************************************************************************************************************************
+  SAMD_TimerADC-Impl.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Timer-paced ADC acquisition. The timer overflow starts each conversion through EVSYS and DMA moves the results into
+  two ping-pong buffers, so the sample spacing is exact and the CPU is only notified once per block.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_ADC_IMPL_H
+#define SAMD_TIMER_ADC_IMPL_H
+
+// There is a single ADC in use, so the DMA block callbacks reach it through this pointer
+SAMDTimerADC* SAMD_ADC_instance = NULL;
+
+void SAMD_ADC_blockA()
+{
+  SAMD_ADC_instance->handleBlock(0);
+}
+
+void SAMD_ADC_blockB()
+{
+  SAMD_ADC_instance->handleBlock(1);
+}
+
+static inline void SAMD_ADC_sync()
+{
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  while (SAMD_TIMER_ADC->SYNCBUSY.reg);
+#else
+  while (SAMD_TIMER_ADC->STATUS.bit.SYNCBUSY);
+#endif
+}
+
+////////////////////////////////////////////////////////
+
+bool SAMDTimerADC::begin(SAMDTimerInterrupt& timer, const uint8_t& pin, const float& sampleRate, 
+                         uint16_t* bufferA, uint16_t* bufferB, const uint16_t& count, adcBlockCallback callback)
+{
+  if ( (bufferA == NULL) || (bufferB == NULL) || (count == 0) || (sampleRate <= 0) )
+    return false;
+    
+  end();
+  
+  _timer      = &timer;
+  _buffer[0]  = bufferA;
+  _buffer[1]  = bufferB;
+  _count      = count;
+  _callback   = callback;
+  _blockCount = 0;
+  
+  SAMD_ADC_instance = this;
+  
+  // Let the core clock the ADC, load its calibration, mux the pin and select it as positive input
+  analogRead(pin);
+  
+  SAMD_TIMER_ADC->CTRLA.reg &= ~ADC_CTRLA_ENABLE;
+  SAMD_ADC_sync();
+  
+  _savedCtrlA     = SAMD_TIMER_ADC->CTRLA.reg;
+  _savedCtrlB     = SAMD_TIMER_ADC->CTRLB.reg;
+  _savedAvgCtrl   = SAMD_TIMER_ADC->AVGCTRL.reg;
+  _savedSampCtrl  = SAMD_TIMER_ADC->SAMPCTRL.reg;
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  // 48MHz / 32 = 1.5MHz ADC clock
+  SAMD_TIMER_ADC->CTRLA.reg = (SAMD_TIMER_ADC->CTRLA.reg & ~ADC_CTRLA_PRESCALER_Msk) | ADC_CTRLA_PRESCALER_DIV32;
+  
+  SAMD_TIMER_ADC->CTRLB.reg = (SAMD_TIMER_ADC->CTRLB.reg & ~(ADC_CTRLB_RESSEL_Msk | ADC_CTRLB_FREERUN)) | ADC_CTRLB_RESSEL_12BIT;
+#else
+  // 48MHz / 32 = 1.5MHz ADC clock
+  SAMD_TIMER_ADC->CTRLB.reg = (SAMD_TIMER_ADC->CTRLB.reg & ~(ADC_CTRLB_PRESCALER_Msk | ADC_CTRLB_RESSEL_Msk | ADC_CTRLB_FREERUN)) | 
+                              ADC_CTRLB_PRESCALER_DIV32 | ADC_CTRLB_RESSEL_12BIT;
+#endif
+  SAMD_ADC_sync();
+  
+  // One conversion per start event, no averaging
+  SAMD_TIMER_ADC->AVGCTRL.reg   = ADC_AVGCTRL_SAMPLENUM_1;
+  SAMD_TIMER_ADC->SAMPCTRL.reg  = ADC_SAMPCTRL_SAMPLEN(SAMD_TIMER_ADC_SAMPLEN);
+  SAMD_ADC_sync();
+  
+  SAMD_TIMER_ADC->EVCTRL.reg    = ADC_EVCTRL_STARTEI;
+  SAMD_TIMER_ADC->INTFLAG.reg   = ADC_INTFLAG_RESRDY | ADC_INTFLAG_OVERRUN;
+  
+  SAMD_TIMER_ADC->CTRLA.reg |= ADC_CTRLA_ENABLE;
+  SAMD_ADC_sync();
+  
+  // RESRDY -> DMA, into bufferA then bufferB
+  if (!_dma.startInput(SAMD_TIMER_ADC_DMAC_ID, &SAMD_TIMER_ADC->RESULT.reg, bufferA, bufferB, count, SAMD_DMA_BEAT_HWORD,
+                       SAMD_ADC_blockA, SAMD_ADC_blockB))
+  {
+    // Also restores the ADC for analogRead(), and leaves the instance stopped
+    end();
+    return false;
+  }
+  
+  // Timer overflow -> EVSYS -> ADC START
+  if (!SAMD_EVSYS_connect(_eventChannel, timer.getEventGenerator(), SAMD_TIMER_ADC_EVSYS_USER))
+  {
+    end();
+    return false;
+  }
+  
+  if (!timer.setTriggerFrequency(sampleRate))
+  {
+    end();
+    return false;
+  }
+  
+  timer.enableEventOutput();
+  
+  TISR_LOGDEBUG3(F("SAMDTimerADC: sampleRate ="), sampleRate, F(", count ="), count);
+  
+  return true;
+}
+
+void SAMDTimerADC::end()
+{
+  if (_timer == NULL)
+    return;
+    
+  _timer->disableTimer();
+  
+  SAMD_EVSYS_disconnect(_eventChannel, SAMD_TIMER_ADC_EVSYS_USER);
+  
+  _dma.stop();
+  
+  SAMD_TIMER_ADC->CTRLA.reg &= ~ADC_CTRLA_ENABLE;
+  SAMD_ADC_sync();
+  
+  // Back to software-started conversions, with the core settings, for analogRead(). It enables the ADC itself
+  SAMD_TIMER_ADC->EVCTRL.reg = 0;
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  // The prescaler is in CTRLA, enable-protected
+  SAMD_TIMER_ADC->CTRLA.reg     = _savedCtrlA & ~ADC_CTRLA_ENABLE;
+  SAMD_ADC_sync();
+#endif
+
+  SAMD_TIMER_ADC->CTRLB.reg     = _savedCtrlB;
+  SAMD_ADC_sync();
+  
+  SAMD_TIMER_ADC->AVGCTRL.reg   = _savedAvgCtrl;
+  SAMD_TIMER_ADC->SAMPCTRL.reg  = _savedSampCtrl;
+  SAMD_ADC_sync();
+  
+  _timer = NULL;
+}
+
+#endif    // SAMD_TIMER_ADC_IMPL_H
@@ -0,0 +1,24 @@
+/****************************************************************************************************************************
+  SAMD_TimerADC.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Timer-paced ADC acquisition. The timer overflow starts each conversion through EVSYS and DMA moves the results into
+  two ping-pong buffers, so the sample spacing is exact and the CPU is only notified once per block.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_ADC_H
+#define SAMD_TIMER_ADC_H
+
+#include "SAMD_TimerDMA.h"
+#include "SAMD_TimerADC.hpp"
+#include "SAMD_TimerADC-Impl.h"
+
+#endif    // SAMD_TIMER_ADC_H
@@ -0,0 +1,106 @@
+/****************************************************************************************************************************
+  SAMD_TimerADC.hpp
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Timer-paced ADC acquisition. The timer overflow starts each conversion through EVSYS and DMA moves the results into
+  two ping-pong buffers, so the sample spacing is exact and the CPU is only notified once per block.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_ADC_HPP
+#define SAMD_TIMER_ADC_HPP
+
+#include "SAMDTimerInterrupt.hpp"
+#include "SAMD_TimerDMA.hpp"
+#include "SAMD_TimerEventSystem.hpp"
+
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  // Only ADC0 is used on SAMD51
+  #define SAMD_TIMER_ADC                ADC0
+  #define SAMD_TIMER_ADC_DMAC_ID        ADC0_DMAC_ID_RESRDY
+  #define SAMD_TIMER_ADC_EVSYS_USER     EVSYS_ID_USER_ADC0_START
+#else
+  #define SAMD_TIMER_ADC                ADC
+  #define SAMD_TIMER_ADC_DMAC_ID        ADC_DMAC_ID_RESRDY
+  #define SAMD_TIMER_ADC_EVSYS_USER     EVSYS_ID_USER_ADC_START
+#endif
+
+// ADC sampling time, in half ADC clock cycles (SAMD21) / ADC clock cycles (SAMD51), minus 1. Increase it for high
+// impedance sources, at the cost of the maximum sample rate
+#ifndef SAMD_TIMER_ADC_SAMPLEN
+  #define SAMD_TIMER_ADC_SAMPLEN        4
+#endif
+
+// Called once per block, with the 12-bit samples of the block just completed. They stay valid until the same buffer
+// is filled again, that is for one more block time. Runs in the DMAC interrupt
+typedef void (*adcBlockCallback) (const uint16_t* samples, const uint16_t& count);
+
+class SAMDTimerADC;
+
+typedef SAMDTimerADC SAMD_TimerADC;
+
+class SAMDTimerADC
+{
+  private:
+    SAMDTimerDMA        _dma;
+    uint8_t             _eventChannel;
+    
+    SAMDTimerInterrupt* _timer;
+    
+    uint16_t*           _buffer[2];
+    uint16_t            _count;
+    
+    adcBlockCallback    _callback;
+    
+    volatile uint32_t   _blockCount;
+    
+    // ADC setup of the core, saved by begin() and restored by end() for analogRead()
+    uint16_t            _savedCtrlA;
+    uint16_t            _savedCtrlB;
+    uint8_t             _savedAvgCtrl;
+    uint8_t             _savedSampCtrl;
+
+  public:
+  
+    SAMDTimerADC(const uint8_t& dmaChannel = 0, const uint8_t& eventChannel = 0) 
+      : _dma(dmaChannel), _eventChannel(eventChannel), _timer(NULL), _count(0), _callback(NULL), _blockCount(0),
+        _savedCtrlA(0), _savedCtrlB(0), _savedAvgCtrl(0), _savedSampCtrl(0)
+    {
+      _buffer[0] = NULL;
+      _buffer[1] = NULL;
+    };
+    
+    // Sample analog 'pin' (an ADC0 pin on SAMD51) at 'sampleRate' Hz into bufferA / bufferB, 'count' samples each.
+    // 'timer' is dedicated to pacing the ADC, its CPU interrupt is turned off. Up to about 200kHz with the default
+    // SAMD_TIMER_ADC_SAMPLEN
+    bool begin(SAMDTimerInterrupt& timer, const uint8_t& pin, const float& sampleRate, 
+               uint16_t* bufferA, uint16_t* bufferB, const uint16_t& count, adcBlockCallback callback);
+    
+    // Stop the acquisition, and give the ADC back to analogRead() with the prescaler, resolution, sampling time and
+    // averaging it had before begin()
+    void end();
+    
+    // Number of blocks completed since begin()
+    uint32_t getBlockCount()
+    {
+      return _blockCount;
+    }
+    
+    // Called by the DMA block callbacks
+    void handleBlock(const uint8_t& block)
+    {
+      _blockCount++;
+      
+      if (_callback != NULL)
+        (*_callback)(_buffer[block], _count);
+    }
+}; // class SAMDTimerADC
+
+#endif    // SAMD_TIMER_ADC_HPP
@@ -0,0 +1,158 @@
+/****************************************************************************************************************************
+  SAMD_TimerBatch-Impl.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Interrupt batching for high-rate timers. The timer runs at the full rate with its CPU interrupt off, and each overflow
+  goes through EVSYS to TCC2 counting events, so the CPU is interrupted once every N periods instead of every period.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_BATCH_IMPL_H
+#define SAMD_TIMER_BATCH_IMPL_H
+
+SAMDTimerBatch* SAMD_batch_instance = NULL;
+
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  // OVF
+  void TCC2_0_Handler()
+  {
+    if (SAMD_batch_instance)
+      SAMD_batch_instance->handleInterrupt();
+  }
+  
+#else
+
+  void TCC2_Handler()
+  {
+    if (SAMD_batch_instance)
+      SAMD_batch_instance->handleInterrupt();
+  }
+  
+#endif
+
+////////////////////////////////////////////////////////
+
+void SAMDTimerBatch::handleInterrupt()
+{
+  SAMD_BATCH_TCC->INTFLAG.reg = TCC_INTFLAG_OVF;
+  
+  _batchCount++;
+  
+  uint64_t periods  = _periodCount + _batchSize;
+  _periodCount      = periods;
+  
+  if (_callback != NULL)
+    (*_callback)(periods);
+}
+
+bool SAMDTimerBatch::begin(SAMDTimerInterrupt& timer, const float& frequency, const uint32_t& batchSize, 
+                           batchCallback callback)
+{
+  if ( (batchSize < 2) || (batchSize > SAMD_BATCH_MAX_SIZE) || (frequency <= 0) )
+    return false;
+    
+  end();
+  
+  // Full rate, no CPU interrupt
+  if (!timer.setTriggerFrequency(frequency))
+    return false;
+    
+  timer.enableEventOutput();
+  
+  _timer        = &timer;
+  _batchSize    = batchSize;
+  _callback     = callback;
+  _batchCount   = 0;
+  _periodCount  = 0;
+  
+  SAMD_batch_instance = this;
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  MCLK->APBCMASK.reg |= MCLK_APBCMASK_TCC2;
+  
+  if (!GCLK->PCHCTRL[TCC2_GCLK_ID].bit.CHEN)
+  {
+    GCLK->PCHCTRL[TCC2_GCLK_ID].reg = GCLK_PCHCTRL_GEN_GCLK1 | GCLK_PCHCTRL_CHEN;
+    while (GCLK->SYNCBUSY.reg > 0);
+  }
+  
+#else
+
+  PM->APBCMASK.reg |= PM_APBCMASK_TCC2;
+  
+  // An 8-bit write to the ID selects the channel to read back
+  *((volatile uint8_t*) &GCLK->CLKCTRL.reg) = GCM_TCC2_TC3;
+  
+  if (!GCLK->CLKCTRL.bit.CLKEN)
+  {
+    REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID(GCM_TCC2_TC3));
+    while ( GCLK->STATUS.bit.SYNCBUSY == 1 );
+  }
+  
+#endif
+
+  SAMD_BATCH_TCC->CTRLA.reg = TCC_CTRLA_SWRST;
+  while (SAMD_BATCH_TCC->SYNCBUSY.bit.SWRST);
+  
+  // One count per timer overflow, OVF every batchSize counts
+  SAMD_BATCH_TCC->EVCTRL.reg  = TCC_EVCTRL_EVACT0_COUNTEV | TCC_EVCTRL_TCEI0;
+  SAMD_BATCH_TCC->WAVE.reg    = TCC_WAVE_WAVEGEN_NFRQ;
+  while (SAMD_BATCH_TCC->SYNCBUSY.bit.WAVE);
+  
+  SAMD_BATCH_TCC->PER.reg = batchSize - 1;
+  while (SAMD_BATCH_TCC->SYNCBUSY.bit.PER);
+  
+  SAMD_BATCH_TCC->INTENCLR.reg  = TCC_INTENCLR_MASK;
+  SAMD_BATCH_TCC->INTFLAG.reg   = TCC_INTFLAG_MASK;
+  SAMD_BATCH_TCC->INTENSET.reg  = TCC_INTENSET_OVF;
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  NVIC_EnableIRQ(TCC2_0_IRQn);
+#else
+  NVIC_EnableIRQ(TCC2_IRQn);
+#endif
+
+  SAMD_BATCH_TCC->CTRLA.reg |= TCC_CTRLA_ENABLE;
+  while (SAMD_BATCH_TCC->SYNCBUSY.bit.ENABLE);
+  
+  // Timer overflow -> EVSYS -> TCC2 EV0
+  if (!SAMD_EVSYS_connect(_eventChannel, timer.getEventGenerator(), EVSYS_ID_USER_TCC2_EV_0))
+  {
+    end();
+    return false;
+  }
+  
+  TISR_LOGDEBUG3(F("SAMDTimerBatch: interrupts / s ="), frequency / batchSize, F(", instead of"), frequency);
+  
+  return true;
+}
+
+void SAMDTimerBatch::end()
+{
+  if (_timer == NULL)
+    return;
+    
+  _timer->disableTimer();
+  
+  SAMD_EVSYS_disconnect(_eventChannel, EVSYS_ID_USER_TCC2_EV_0);
+  
+  SAMD_BATCH_TCC->INTENCLR.reg = TCC_INTENCLR_MASK;
+  
+  SAMD_BATCH_TCC->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+  while (SAMD_BATCH_TCC->SYNCBUSY.bit.ENABLE);
+  
+  SAMD_batch_instance = NULL;
+  
+  _timer = NULL;
+}
+
+#endif    // SAMD_TIMER_BATCH_IMPL_H
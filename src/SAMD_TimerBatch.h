@@ -0,0 +1,23 @@
+/****************************************************************************************************************************
+  SAMD_TimerBatch.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Interrupt batching for high-rate timers. The timer runs at the full rate with its CPU interrupt off, and each overflow
+  goes through EVSYS to TCC2 counting events, so the CPU is interrupted once every N periods instead of every period.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_BATCH_H
+#define SAMD_TIMER_BATCH_H
+
+#include "SAMD_TimerBatch.hpp"
+#include "SAMD_TimerBatch-Impl.h"
+
+#endif    // SAMD_TIMER_BATCH_H
@@ -0,0 +1,99 @@
+/****************************************************************************************************************************
+  SAMD_TimerBatch.hpp
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Interrupt batching for high-rate timers. The timer runs at the full rate with its CPU interrupt off, and each overflow
+  goes through EVSYS to TCC2 counting events, so the CPU is interrupted once every N periods instead of every period.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_BATCH_HPP
+#define SAMD_TIMER_BATCH_HPP
+
+#include "SAMDTimerInterrupt.hpp"
+#include "SAMD_TimerEventSystem.hpp"
+
+// TCC2 counts the periods. It can't be used for analogWrite() on its pins at the same time. On SAMD21 it shares its
+// GCLK channel with TC3, which is left as is when already running
+#define SAMD_BATCH_TCC                TCC2
+#define SAMD_BATCH_MAX_SIZE           0x10000
+
+// Called once per batch, in the TCC2 interrupt, with the number of timer periods elapsed since begin()
+typedef void (*batchCallback) (const uint64_t& periods);
+
+class SAMDTimerBatch;
+
+typedef SAMDTimerBatch SAMD_TimerBatch;
+
+class SAMDTimerBatch
+{
+  private:
+    uint8_t             _eventChannel;
+    
+    SAMDTimerInterrupt* _timer;
+    uint32_t            _batchSize;
+    
+    batchCallback       _callback;
+    
+    volatile uint32_t   _batchCount;
+    volatile uint64_t   _periodCount;     // 64-bit: a uint32_t wraps after about 6h at 200kHz
+
+  public:
+  
+    SAMDTimerBatch(const uint8_t& eventChannel = 3)
+      : _eventChannel(eventChannel), _timer(NULL), _batchSize(1), _callback(NULL), _batchCount(0), _periodCount(0)
+    {
+    };
+    
+    // Run 'timer' at 'frequency' Hz and call 'callback' every 'batchSize' periods, 2 to SAMD_BATCH_MAX_SIZE.
+    // 'timer' is dedicated to the batch, its own CPU interrupt is turned off
+    bool begin(SAMDTimerInterrupt& timer, const float& frequency, const uint32_t& batchSize, batchCallback callback);
+    
+    void end();
+    
+    uint32_t getBatchSize()
+    {
+      return _batchSize;
+    }
+    
+    // Number of batches completed since begin(). Wraps after 2^32 batches, use getPeriodCount() for long runs
+    uint32_t getBatchCount()
+    {
+      return _batchCount;
+    }
+    
+    // Timer periods covered by the completed batches
+    uint64_t getPeriodCount()
+    {
+      // The TCC2 interrupt must not update the count between the two 32-bit halves
+      uint32_t primask = __get_PRIMASK();
+      
+      __disable_irq();
+      
+      uint64_t periods = _periodCount;
+      
+      __set_PRIMASK(primask);
+      
+      return periods;
+    }
+    
+    // Interrupts that one-per-period attachInterrupt() would have taken on top of the batch ones
+    uint64_t getInterruptsSaved()
+    {
+      uint64_t periods = getPeriodCount();
+      
+      return periods - periods / _batchSize;
+    }
+    
+    // Called by the TCC2 interrupt
+    void handleInterrupt();
+}; // class SAMDTimerBatch
+
+#endif    // SAMD_TIMER_BATCH_HPP
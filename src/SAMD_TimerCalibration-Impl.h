@@ -0,0 +1,153 @@
+/****************************************************************************************************************************
+  SAMD_TimerCalibration-Impl.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Clock calibration. The 48MHz timer clock is measured against the 32.768kHz crystal (XOSC32K), and the error found is
+  applied to the period math of every timer, so setFrequency() / setInterval() are corrected without a reference input.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_CALIBRATION_IMPL_H
+#define SAMD_TIMER_CALIBRATION_IMPL_H
+
+float SAMD_calibrationPpm = 0;
+
+volatile uint64_t SAMD_calibrationTicks;
+volatile uint32_t SAMD_calibrationPeriods;
+
+void SAMD_calibrationCapture(const uint32_t& period, const uint32_t& pulseWidth)
+{
+  (void) pulseWidth;
+  
+  // 0 => no reference edge within maxPeriod
+  if (period)
+  {
+    SAMD_calibrationTicks += period;
+    SAMD_calibrationPeriods++;
+  }
+}
+
+// Start the 32.768kHz crystal oscillator, unless the core or the RTC did already
+bool SAMD_startXOSC32K()
+{
+  uint32_t start = millis();
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  if (!OSC32KCTRL->STATUS.bit.XOSC32KRDY)
+  {
+    // Not ONDEMAND, so it runs and gets ready before any GCLK requests it
+    OSC32KCTRL->XOSC32K.reg = OSC32KCTRL_XOSC32K_ENABLE | OSC32KCTRL_XOSC32K_EN32K | OSC32KCTRL_XOSC32K_CGM_XT |
+                              OSC32KCTRL_XOSC32K_XTALEN;
+                              
+    while (!OSC32KCTRL->STATUS.bit.XOSC32KRDY)
+    {
+      if (millis() - start > SAMD_XOSC32K_TIMEOUT_MS)
+        return false;
+    }
+  }
+  
+#else
+
+  if (!SYSCTRL->PCLKSR.bit.XOSC32KRDY)
+  {
+    SYSCTRL->XOSC32K.reg = SYSCTRL_XOSC32K_STARTUP(6) | SYSCTRL_XOSC32K_XTALEN | SYSCTRL_XOSC32K_EN32K;
+    SYSCTRL->XOSC32K.reg |= SYSCTRL_XOSC32K_ENABLE;
+    
+    while (!SYSCTRL->PCLKSR.bit.XOSC32KRDY)
+    {
+      if (millis() - start > SAMD_XOSC32K_TIMEOUT_MS)
+        return false;
+    }
+  }
+  
+#endif
+
+  return true;
+}
+
+////////////////////////////////////////////////////////
+
+bool SAMD_calibrateClock(SAMDTimerInterrupt& timer, SAMDTimerCapture& capture, const uint32_t& window)
+{
+  if (!SAMD_startXOSC32K())
+  {
+    TISR_LOGWARN(F("SAMD_calibrateClock: XOSC32K not ready"));
+    
+    return false;
+  }
+  
+  // Measure the raw clock. The correction would also skew the reference period
+  int32_t previousError = SAMD_getClockError();
+  
+  // The caller's clock source, restored afterwards
+  uint8_t  previousGenerator  = timer.getClockGenerator();
+  uint32_t previousHz         = timer.getClockFrequency();
+  
+  SAMD_setClockError(0);
+  
+  SAMD_calibrationTicks   = 0;
+  SAMD_calibrationPeriods = 0;
+  
+  bool started = timer.configureClockGenerator(SAMD_CALIBRATION_GCLK, GCLK_GENCTRL_SRC_XOSC32K_Val, 32768, 1) &&
+                 timer.setTriggerPeriod(SAMD_CALIBRATION_PERIOD);
+                 
+  if (started)
+  {
+    timer.enableEventOutput();
+    
+    started = capture.beginEvent(timer.getEventGenerator(), SAMD_calibrationCapture, SAMD_CALIBRATION_PERIOD * 1.5f);
+  }
+  
+  if (started)
+    delay(window);
+    
+  capture.end();
+  timer.disableTimer();
+  
+  // Back to the caller's generator, programmed again by the next attach
+  timer.setClockSource(previousGenerator, previousHz);
+  
+  noInterrupts();
+  
+  uint64_t ticks    = SAMD_calibrationTicks;
+  uint32_t periods  = SAMD_calibrationPeriods;
+  
+  interrupts();
+  
+  if (!started || (periods == 0))
+  {
+    TISR_LOGWARN(F("SAMD_calibrateClock: no reference period captured"));
+    
+    SAMD_setClockError(previousError);
+    
+    return false;
+  }
+  
+  double expected = (double) periods * capture.getTickFrequency() * (SAMD_CALIBRATION_PERIOD / 1000000.0);
+  int32_t ppb     = (int32_t) ((ticks / expected - 1.0) * 1e9);
+  
+  TISR_LOGDEBUG3(F("SAMD_calibrateClock: periods = "), periods, F(", ppb = "), ppb);
+  
+  SAMD_calibrationPpm = ppb / 1000.0f;
+  
+  SAMD_setClockError(ppb);
+  
+  return true;
+}
+
+////////////////////////////////////////////////////////
+
+float SAMD_getCalibrationError()
+{
+  return SAMD_calibrationPpm;
+}
+
+#endif    // SAMD_TIMER_CALIBRATION_IMPL_H
@@ -0,0 +1,24 @@
+/****************************************************************************************************************************
+  SAMD_TimerCalibration.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Clock calibration. The 48MHz timer clock is measured against the 32.768kHz crystal (XOSC32K), and the error found is
+  applied to the period math of every timer, so setFrequency() / setInterval() are corrected without a reference input.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_CALIBRATION_H
+#define SAMD_TIMER_CALIBRATION_H
+
+#include "SAMD_TimerCapture.h"
+#include "SAMD_TimerCalibration.hpp"
+#include "SAMD_TimerCalibration-Impl.h"
+
+#endif    // SAMD_TIMER_CALIBRATION_H
@@ -0,0 +1,45 @@
+/****************************************************************************************************************************
+  SAMD_TimerCalibration.hpp
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Clock calibration. The 48MHz timer clock is measured against the 32.768kHz crystal (XOSC32K), and the error found is
+  applied to the period math of every timer, so setFrequency() / setInterval() are corrected without a reference input.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_CALIBRATION_HPP
+#define SAMD_TIMER_CALIBRATION_HPP
+
+#include "SAMDTimerInterrupt.hpp"
+#include "SAMD_TimerCapture.hpp"
+
+// GCLK generator switched to XOSC32K during the calibration. Not used by the Arduino / Adafruit cores
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  #define SAMD_CALIBRATION_GCLK       6
+#else
+  #define SAMD_CALIBRATION_GCLK       4
+#endif
+
+// Reference period (us): 1024 cycles of the 32.768kHz crystal
+#define SAMD_CALIBRATION_PERIOD       31250
+
+// Longest XOSC32K start-up accepted, some crystals need up to 1s
+#define SAMD_XOSC32K_TIMEOUT_MS       2000
+
+// Measure the timer clock against XOSC32K for 'window' ms, then apply the error with SAMD_setClockError().
+// 'timer' runs from XOSC32K to produce the reference periods, which 'capture' (TCC1) measures at 48MHz through EVSYS.
+// Both are stopped afterwards. 'timer' gets back the clock source it had before, but must be re-attached to run again.
+// Returns false, and leaves the correction unchanged, if XOSC32K doesn't start, e.g. no crystal fitted
+bool SAMD_calibrateClock(SAMDTimerInterrupt& timer, SAMDTimerCapture& capture, const uint32_t& window = 500);
+
+// Error of the timer clock found by the last successful SAMD_calibrateClock(), in ppm. 0 before
+float SAMD_getCalibrationError();
+
+#endif    // SAMD_TIMER_CALIBRATION_HPP
@@ -0,0 +1,203 @@
+/****************************************************************************************************************************
+  SAMD_TimerCapture-Impl.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Hardware input capture. The pin edge goes from the EIC through EVSYS to TCC1, which captures the period and the pulse
+  width of the signal at counter resolution (20.8ns at 48MHz), with one interrupt per period or a DMA-filled buffer.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_CAPTURE_IMPL_H
+#define SAMD_TIMER_CAPTURE_IMPL_H
+
+SAMDTimerCapture* SAMD_capture_instance = NULL;
+
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  // OVF, ERR, etc.
+  void TCC1_0_Handler()
+  {
+    if (SAMD_capture_instance)
+      SAMD_capture_instance->handleInterrupt();
+  }
+  
+  // MC0
+  void TCC1_1_Handler()
+  {
+    if (SAMD_capture_instance)
+      SAMD_capture_instance->handleInterrupt();
+  }
+  
+#else
+
+  void TCC1_Handler()
+  {
+    if (SAMD_capture_instance)
+      SAMD_capture_instance->handleInterrupt();
+  }
+  
+#endif
+
+////////////////////////////////////////////////////////
+
+void SAMDTimerCapture::handleInterrupt()
+{
+  uint32_t flags = SAMD_CAPTURE_TCC->INTFLAG.reg;
+  
+  if (flags & TCC_INTFLAG_MC0)
+  {
+    // Reading CC0 clears MC0
+    uint32_t period     = SAMD_CAPTURE_TCC->CC[0].reg;
+    uint32_t pulseWidth = SAMD_CAPTURE_TCC->CC[1].reg;
+    
+    SAMD_CAPTURE_TCC->INTFLAG.reg = TCC_INTFLAG_MC0 | TCC_INTFLAG_MC1;
+    
+    if (_overflowed)
+    {
+      // First edge after a stop, the counter restarts from here
+      _overflowed = false;
+    }
+    else
+    {
+      _period     = period;
+      _pulseWidth = pulseWidth;
+      
+      _captureCount++;
+      
+      if (_callback != NULL)
+        (*_callback)(period, pulseWidth);
+    }
+  }
+  
+  if (flags & TCC_INTFLAG_OVF)
+  {
+    SAMD_CAPTURE_TCC->INTFLAG.reg = TCC_INTFLAG_OVF;
+    
+    // No edge for a whole counter range
+    if (!_overflowed)
+    {
+      _overflowed = true;
+      _period     = 0;
+      _pulseWidth = 0;
+      
+      if (_callback != NULL)
+        (*_callback)(0, 0);
+    }
+  }
+}
+
+bool SAMDTimerCapture::begin(const uint8_t& pin, captureCallback callback, const float& maxPeriod)
+{
+  end();
+  
+  // The EIC line follows the pin level, TCC1 sees its edges
+  int8_t extInt = SAMD_EIC_enableEvent(pin, HIGH);
+  
+  if (extInt < 0)
+    return false;
+  
+  return beginEvent(EVSYS_ID_GEN_EIC_EXTINT_0 + extInt, callback, maxPeriod);
+}
+
+bool SAMDTimerCapture::beginEvent(const uint8_t& generator, captureCallback callback, const float& maxPeriod)
+{
+  end();
+  
+  _generator    = generator;
+  _callback     = callback;
+  _period       = 0;
+  _pulseWidth   = 0;
+  _captureCount = 0;
+  _overflowed   = true;
+  
+  SAMD_capture_instance = this;
+  
+  uint8_t prescalerIndex = SAMD_selectPrescaler(maxPeriod, TIMER_HZ, SAMD_CAPTURE_MAX_COUNT);
+  
+  _tickHz = TIMER_HZ / SAMD_prescalerDivider[prescalerIndex];
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  MCLK->APBBMASK.reg |= MCLK_APBBMASK_TCC1;
+  
+  GCLK->PCHCTRL[TCC1_GCLK_ID].reg = GCLK_PCHCTRL_GEN_GCLK1 | GCLK_PCHCTRL_CHEN;
+  while (GCLK->SYNCBUSY.reg > 0);
+  
+#else
+
+  PM->APBCMASK.reg |= PM_APBCMASK_TCC1;
+  
+  REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID(GCM_TCC0_TCC1));
+  while ( GCLK->STATUS.bit.SYNCBUSY == 1 );
+  
+#endif
+
+  SAMD_CAPTURE_TCC->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+  while (SAMD_CAPTURE_TCC->SYNCBUSY.bit.ENABLE);
+  
+  // Period into CC0, pulse width into CC1. The counter restarts on each period
+  SAMD_CAPTURE_TCC->CTRLA.reg   = TCC_CTRLA_PRESCALER(prescalerIndex) | TCC_CTRLA_CPTEN0 | TCC_CTRLA_CPTEN1;
+  SAMD_CAPTURE_TCC->EVCTRL.reg  = TCC_EVCTRL_EVACT1_PPW | TCC_EVCTRL_TCEI1;
+  
+  SAMD_CAPTURE_TCC->PER.reg = SAMD_CAPTURE_MAX_COUNT;
+  while (SAMD_CAPTURE_TCC->SYNCBUSY.bit.PER);
+  
+  SAMD_CAPTURE_TCC->INTENCLR.reg  = TCC_INTENCLR_MASK;
+  SAMD_CAPTURE_TCC->INTFLAG.reg   = TCC_INTFLAG_MASK;
+  SAMD_CAPTURE_TCC->INTENSET.reg  = TCC_INTENSET_MC0 | TCC_INTENSET_OVF;
+  
+  // EIC EXTINT n (or another generator) -> EVSYS -> TCC1 EV1
+  SAMD_EVSYS_connect(_eventChannel, _generator, EVSYS_ID_USER_TCC1_EV_1);
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  NVIC_EnableIRQ(TCC1_0_IRQn);
+  NVIC_EnableIRQ(TCC1_1_IRQn);
+#else
+  NVIC_EnableIRQ(TCC1_IRQn);
+#endif
+
+  SAMD_CAPTURE_TCC->CTRLA.reg |= TCC_CTRLA_ENABLE;
+  while (SAMD_CAPTURE_TCC->SYNCBUSY.bit.ENABLE);
+  
+  TISR_LOGDEBUG3(F("SAMDTimerCapture: generator ="), _generator, F(", tick Hz ="), _tickHz);
+  
+  return true;
+}
+
+// Inline, so that only the sketches calling it need SAMDTimerDMA, and its DMAC handlers, from SAMD_TimerDMA.h
+inline bool SAMDTimerCapture::startDMA(SAMDTimerDMA& dma, uint32_t* bufferA, uint32_t* bufferB, const uint16_t& count,
+                                       timerCallback callbackA, timerCallback callbackB)
+{
+  if (SAMD_capture_instance != this)
+    return false;
+    
+  // The DMA read of CC0 clears MC0, only keep the stall detection
+  SAMD_CAPTURE_TCC->INTENCLR.reg = TCC_INTENCLR_MC0;
+  
+  return dma.startInput(TCC1_DMAC_ID_MC_0, &SAMD_CAPTURE_TCC->CC[0].reg, bufferA, bufferB, count, SAMD_DMA_BEAT_WORD,
+                        callbackA, callbackB);
+}
+
+void SAMDTimerCapture::end()
+{
+  if (SAMD_capture_instance != this)
+    return;
+    
+  SAMD_CAPTURE_TCC->INTENCLR.reg = TCC_INTENCLR_MASK;
+  
+  SAMD_CAPTURE_TCC->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+  while (SAMD_CAPTURE_TCC->SYNCBUSY.bit.ENABLE);
+  
+  SAMD_EVSYS_disconnect(_eventChannel, EVSYS_ID_USER_TCC1_EV_1);
+  
+  SAMD_capture_instance = NULL;
+}
+
+#endif    // SAMD_TIMER_CAPTURE_IMPL_H
@@ -0,0 +1,23 @@
+/****************************************************************************************************************************
+  SAMD_TimerCapture.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Hardware input capture. The pin edge goes from the EIC through EVSYS to TCC1, which captures the period and the pulse
+  width of the signal at counter resolution (20.8ns at 48MHz), with one interrupt per period or a DMA-filled buffer.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_CAPTURE_H
+#define SAMD_TIMER_CAPTURE_H
+
+#include "SAMD_TimerCapture.hpp"
+#include "SAMD_TimerCapture-Impl.h"
+
+#endif    // SAMD_TIMER_CAPTURE_H
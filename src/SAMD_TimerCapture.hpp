@@ -0,0 +1,112 @@
+/****************************************************************************************************************************
+  SAMD_TimerCapture.hpp
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Hardware input capture. The pin edge goes from the EIC through EVSYS to TCC1, which captures the period and the pulse
+  width of the signal at counter resolution (20.8ns at 48MHz), with one interrupt per period or a DMA-filled buffer.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_CAPTURE_HPP
+#define SAMD_TIMER_CAPTURE_HPP
+
+#include "SAMDTimerInterrupt.hpp"
+#include "SAMD_TimerDMA.hpp"
+#include "SAMD_TimerEventSystem.hpp"
+
+// TCC1 is used for capture. It can't be used for analogWrite() on its pins at the same time, and it shares its GCLK
+// channel with TCC0, so both must run from the same 48MHz generator
+#define SAMD_CAPTURE_TCC              TCC1
+#define SAMD_CAPTURE_MAX_COUNT        0xFFFFFF
+
+// Called on each period, in the interrupt, with the period and the high pulse width in ticks. 0, 0 when the signal
+// stopped for a whole counter range
+typedef void (*captureCallback) (const uint32_t& period, const uint32_t& pulseWidth);
+
+class SAMDTimerCapture;
+
+typedef SAMDTimerCapture SAMD_TimerCapture;
+
+class SAMDTimerCapture
+{
+  private:
+    uint8_t             _eventChannel;
+    uint8_t             _generator;
+    
+    uint32_t            _tickHz;
+    
+    captureCallback     _callback;
+    
+    volatile uint32_t   _period;
+    volatile uint32_t   _pulseWidth;
+    volatile uint32_t   _captureCount;
+    
+    // The counter wrapped since the last edge, so the next capture is not a whole period
+    volatile bool       _overflowed;
+
+  public:
+  
+    SAMDTimerCapture(const uint8_t& eventChannel = 1)
+      : _eventChannel(eventChannel), _generator(0), _tickHz(TIMER_HZ), _callback(NULL), 
+        _period(0), _pulseWidth(0), _captureCount(0), _overflowed(true)
+    {
+    };
+    
+    // Measure the signal on 'pin', which must be an external interrupt pin. The prescaler is chosen for the
+    // longest expected period maxPeriod (us). The period starts on the rising edge
+    bool begin(const uint8_t& pin, captureCallback callback = NULL, const float& maxPeriod = 300000);
+    
+    // Same, for the events of 'generator' (EVSYS_ID_GEN_xxx) instead of a pin, e.g. the overflow of another timer
+    // running from a reference clock
+    bool beginEvent(const uint8_t& generator, captureCallback callback = NULL, const float& maxPeriod = 300000);
+    
+    // Instead of interrupting on each period, let 'dma' store the periods (in ticks) into bufferA / bufferB,
+    // 'count' each. callbackA / callbackB run once the matching buffer is full. Include SAMD_TimerDMA.h to use it
+    bool startDMA(SAMDTimerDMA& dma, uint32_t* bufferA, uint32_t* bufferB, const uint16_t& count,
+                  timerCallback callbackA, timerCallback callbackB);
+    
+    void end();
+    
+    // Last period / pulse width, in ticks. 0 if the signal stopped
+    uint32_t getPeriodTicks()
+    {
+      return _period;
+    }
+    
+    uint32_t getPulseWidthTicks()
+    {
+      return _pulseWidth;
+    }
+    
+    // Counter frequency (Hz), ticks / s
+    uint32_t getTickFrequency()
+    {
+      return _tickHz;
+    }
+    
+    // Signal frequency (Hz). 0 if the signal stopped
+    float getFrequency()
+    {
+      uint32_t period = _period;
+      
+      return (period == 0) ? 0 : ( (float) _tickHz / period );
+    }
+    
+    // Number of periods captured since begin()
+    uint32_t getCaptureCount()
+    {
+      return _captureCount;
+    }
+    
+    // Called by the TCC1 handler
+    void handleInterrupt();
+}; // class SAMDTimerCapture
+
+#endif    // SAMD_TIMER_CAPTURE_HPP
@@ -0,0 +1,274 @@
+/****************************************************************************************************************************
+  SAMD_TimerDMA-Impl.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  DMAC channels paced by a SAMDTimerInterrupt timer. Every timer overflow moves one beat between a buffer and a
+  peripheral register, such as DAC DATA or PORT OUTTGL, without any CPU work. Only the block callbacks run on the CPU.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_DMA_IMPL_H
+#define SAMD_TIMER_DMA_IMPL_H
+
+// First descriptor of each channel, fetched by the DMAC from BASEADDR
+__attribute__((__aligned__(16))) DmacDescriptor SAMD_DMA_descriptor[SAMD_TIMER_DMA_NUM_CHANNELS];
+
+// Active descriptor of each channel, written back by the DMAC to WRBADDR
+__attribute__((__aligned__(16))) DmacDescriptor SAMD_DMA_writeback[SAMD_TIMER_DMA_NUM_CHANNELS];
+
+// Second descriptor of each channel, linked with the first one into a ring
+__attribute__((__aligned__(16))) DmacDescriptor SAMD_DMA_linked[SAMD_TIMER_DMA_NUM_CHANNELS];
+
+SAMDTimerDMA* SAMD_DMA_channel[SAMD_TIMER_DMA_NUM_CHANNELS];
+
+bool SAMD_DMA_initialized = false;
+
+////////////////////////////////////////////////////////
+
+static void SAMD_DMA_init()
+{
+  if (SAMD_DMA_initialized)
+    return;
+    
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  MCLK->AHBMASK.reg |= MCLK_AHBMASK_DMAC;
+#else
+  PM->AHBMASK.reg |= PM_AHBMASK_DMAC;
+  PM->APBBMASK.reg |= PM_APBBMASK_DMAC;
+#endif
+
+  DMAC->CTRL.reg &= ~DMAC_CTRL_DMAENABLE;
+  
+  DMAC->BASEADDR.reg  = (uint32_t) SAMD_DMA_descriptor;
+  DMAC->WRBADDR.reg   = (uint32_t) SAMD_DMA_writeback;
+  
+  DMAC->CTRL.reg      = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+  
+  SAMD_DMA_initialized = true;
+}
+
+// Clear the flags of our channels in [first, last] and dispatch the completed blocks
+static inline void SAMD_DMA_dispatch(const uint8_t& first, const uint8_t& last)
+{
+  for (uint8_t channel = first; (channel <= last) && (channel < SAMD_TIMER_DMA_NUM_CHANNELS); channel++)
+  {
+    if (SAMD_DMA_channel[channel] == NULL)
+      continue;
+      
+#if (TIMER_INTERRUPT_USING_SAMD51)
+    uint8_t flags = DMAC->Channel[channel].CHINTFLAG.reg & (DMAC_CHINTFLAG_TCMPL | DMAC_CHINTFLAG_TERR);
+    
+    DMAC->Channel[channel].CHINTFLAG.reg = flags;
+#else
+    DMAC->CHID.reg = DMAC_CHID_ID(channel);
+    
+    uint8_t flags = DMAC->CHINTFLAG.reg & (DMAC_CHINTFLAG_TCMPL | DMAC_CHINTFLAG_TERR);
+    
+    DMAC->CHINTFLAG.reg = flags;
+#endif
+
+    if (flags & DMAC_CHINTFLAG_TCMPL)
+      SAMD_DMA_channel[channel]->handleInterrupt();
+  }
+}
+
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  // One vector for each of channels 0-3, and a shared one for the others
+  void DMAC_0_Handler()
+  {
+    SAMD_DMA_dispatch(0, 0);
+  }
+  
+  void DMAC_1_Handler()
+  {
+    SAMD_DMA_dispatch(1, 1);
+  }
+  
+  void DMAC_2_Handler()
+  {
+    SAMD_DMA_dispatch(2, 2);
+  }
+  
+  void DMAC_3_Handler()
+  {
+    SAMD_DMA_dispatch(3, 3);
+  }
+  
+  void DMAC_4_Handler()
+  {
+    SAMD_DMA_dispatch(4, 31);
+  }
+
+#else
+
+  void DMAC_Handler()
+  {
+    // Restore CHID, the handler may interrupt a channel access in progress
+    uint8_t channelID = DMAC->CHID.reg;
+    
+    SAMD_DMA_dispatch(0, SAMD_TIMER_DMA_NUM_CHANNELS - 1);
+    
+    DMAC->CHID.reg = channelID;
+  }
+
+#endif
+
+////////////////////////////////////////////////////////
+
+bool SAMDTimerDMA::_start(const uint8_t& triggerSource, const SAMDDMABeatSize& beatSize, const uint16_t& count,
+                          const void* sourceA, const void* sourceB, const bool& sourceIncrement,
+                          volatile void* destinationA, volatile void* destinationB, const bool& destinationIncrement,
+                          timerCallback callbackA, timerCallback callbackB)
+{
+  if ( (_channel >= SAMD_TIMER_DMA_NUM_CHANNELS) || (count == 0) )
+    return false;
+    
+  SAMD_DMA_init();
+  
+  stop();
+  
+  uint32_t blockBytes = (uint32_t) count << beatSize;
+  
+  uint16_t btctrl = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BLOCKACT_INT | DMAC_BTCTRL_BEATSIZE(beatSize) |
+                    (sourceIncrement ? DMAC_BTCTRL_SRCINC : 0) | (destinationIncrement ? DMAC_BTCTRL_DSTINC : 0);
+  
+  // An incremented address is given as the end of the block
+  DmacDescriptor* descriptor = &SAMD_DMA_descriptor[_channel];
+  
+  descriptor->BTCTRL.reg    = btctrl;
+  descriptor->BTCNT.reg     = count;
+  descriptor->SRCADDR.reg   = (uint32_t) sourceA + (sourceIncrement ? blockBytes : 0);
+  descriptor->DSTADDR.reg   = (uint32_t) destinationA + (destinationIncrement ? blockBytes : 0);
+  descriptor->DESCADDR.reg  = (uint32_t) &SAMD_DMA_linked[_channel];
+  
+  descriptor = &SAMD_DMA_linked[_channel];
+  
+  descriptor->BTCTRL.reg    = btctrl;
+  descriptor->BTCNT.reg     = count;
+  descriptor->SRCADDR.reg   = (uint32_t) sourceB + (sourceIncrement ? blockBytes : 0);
+  descriptor->DSTADDR.reg   = (uint32_t) destinationB + (destinationIncrement ? blockBytes : 0);
+  descriptor->DESCADDR.reg  = (uint32_t) &SAMD_DMA_descriptor[_channel];
+  
+  _callback[0]  = callbackA;
+  _callback[1]  = callbackB;
+  _block        = 0;
+  
+  SAMD_DMA_channel[_channel] = this;
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  DmacChannel* channel = &DMAC->Channel[_channel];
+  
+  channel->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+  while (channel->CHCTRLA.bit.SWRST);
+  
+  // One beat per trigger
+  channel->CHCTRLA.reg    = DMAC_CHCTRLA_TRIGSRC(triggerSource) | DMAC_CHCTRLA_TRIGACT_BURST | DMAC_CHCTRLA_BURSTLEN_SINGLE;
+  channel->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL | DMAC_CHINTENSET_TERR;
+  
+  IRQn_Type irq = (IRQn_Type) ( (_channel < 4) ? (DMAC_0_IRQn + _channel) : DMAC_4_IRQn );
+  
+  NVIC_EnableIRQ(irq);
+  
+  channel->CHCTRLA.reg |= DMAC_CHCTRLA_ENABLE;
+  
+#else
+
+  noInterrupts();
+  
+  DMAC->CHID.reg    = DMAC_CHID_ID(_channel);
+  DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+  while (DMAC->CHCTRLA.bit.SWRST);
+  
+  // One beat per trigger
+  DMAC->CHCTRLB.reg     = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(triggerSource) | DMAC_CHCTRLB_TRIGACT_BEAT;
+  DMAC->CHINTENSET.reg  = DMAC_CHINTENSET_TCMPL | DMAC_CHINTENSET_TERR;
+  DMAC->CHCTRLA.reg     = DMAC_CHCTRLA_ENABLE;
+  
+  interrupts();
+  
+  NVIC_EnableIRQ(DMAC_IRQn);
+
+#endif
+
+  TISR_LOGDEBUG3(F("SAMDTimerDMA: channel ="), _channel, F(", trigger ="), triggerSource);
+  TISR_LOGDEBUG3(F("count ="), count, F(", beatSize ="), beatSize);
+  
+  return true;
+}
+
+bool SAMDTimerDMA::startOutput(const uint8_t& triggerSource, const void* buffer, const uint16_t& count, 
+                               const SAMDDMABeatSize& beatSize, volatile void* destination, 
+                               timerCallback halfCallback, timerCallback fullCallback)
+{
+  // Two descriptors, one per half, so that each half raises its own block interrupt
+  uint16_t halfCount = count / 2;
+  
+  if ( (count < 2) || (count & 1) )
+    return false;
+    
+  return _start(triggerSource, beatSize, halfCount, buffer, (const uint8_t*) buffer + ((uint32_t) halfCount << beatSize), true,
+                destination, destination, false, halfCallback, fullCallback);
+}
+
+bool SAMDTimerDMA::startOutputDoubleBuffer(const uint8_t& triggerSource, const void* bufferA, const void* bufferB, 
+                                           const uint16_t& count, const SAMDDMABeatSize& beatSize, volatile void* destination,
+                                           timerCallback callbackA, timerCallback callbackB)
+{
+  return _start(triggerSource, beatSize, count, bufferA, bufferB, true, destination, destination, false, callbackA, callbackB);
+}
+
+bool SAMDTimerDMA::startInput(const uint8_t& triggerSource, volatile void* source, void* bufferA, void* bufferB,
+                              const uint16_t& count, const SAMDDMABeatSize& beatSize, 
+                              timerCallback callbackA, timerCallback callbackB)
+{
+  return _start(triggerSource, beatSize, count, (const void*) source, (const void*) source, false, bufferA, bufferB, true, 
+                callbackA, callbackB);
+}
+
+void SAMDTimerDMA::stop()
+{
+  if (_channel >= SAMD_TIMER_DMA_NUM_CHANNELS)
+    return;
+    
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  DMAC->Channel[_channel].CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+  while (DMAC->Channel[_channel].CHCTRLA.bit.ENABLE);
+#else
+  noInterrupts();
+  
+  DMAC->CHID.reg = DMAC_CHID_ID(_channel);
+  DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+  
+  interrupts();
+#endif
+}
+
+bool SAMDTimerDMA::isRunning()
+{
+  if ( (_channel >= SAMD_TIMER_DMA_NUM_CHANNELS) || !SAMD_DMA_initialized )
+    return false;
+    
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  return DMAC->Channel[_channel].CHCTRLA.bit.ENABLE;
+#else
+  noInterrupts();
+  
+  DMAC->CHID.reg = DMAC_CHID_ID(_channel);
+  bool enabled = DMAC->CHCTRLA.bit.ENABLE;
+  
+  interrupts();
+  
+  return enabled;
+#endif
+}
+
+#endif    // SAMD_TIMER_DMA_IMPL_H
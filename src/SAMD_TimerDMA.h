@@ -0,0 +1,23 @@
+/****************************************************************************************************************************
+  SAMD_TimerDMA.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  DMAC channels paced by a SAMDTimerInterrupt timer. Every timer overflow moves one beat between a buffer and a
+  peripheral register, such as DAC DATA or PORT OUTTGL, without any CPU work. Only the block callbacks run on the CPU.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_DMA_H
+#define SAMD_TIMER_DMA_H
+
+#include "SAMD_TimerDMA.hpp"
+#include "SAMD_TimerDMA-Impl.h"
+
+#endif    // SAMD_TIMER_DMA_H
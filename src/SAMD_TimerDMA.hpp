@@ -0,0 +1,101 @@
+/****************************************************************************************************************************
+  SAMD_TimerDMA.hpp
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  DMAC channels paced by a SAMDTimerInterrupt timer. Every timer overflow moves one beat between a buffer and a
+  peripheral register, such as DAC DATA or PORT OUTTGL, without any CPU work. Only the block callbacks run on the CPU.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_DMA_HPP
+#define SAMD_TIMER_DMA_HPP
+
+#include "SAMDTimerInterrupt.hpp"
+
+// DMAC channels 0 .. (SAMD_TIMER_DMA_NUM_CHANNELS - 1) can be used. Each one reserves three 16-byte descriptors in SRAM.
+// The DMAC descriptor base address is global, so other DMA users (Adafruit_ZeroDMA, I2S, etc.) can't run at the same time
+#ifndef SAMD_TIMER_DMA_NUM_CHANNELS
+  #define SAMD_TIMER_DMA_NUM_CHANNELS     4
+#endif
+
+typedef enum
+{
+  SAMD_DMA_BEAT_BYTE    = 0,
+  SAMD_DMA_BEAT_HWORD   = 1,
+  SAMD_DMA_BEAT_WORD    = 2
+} SAMDDMABeatSize;
+
+class SAMDTimerDMA;
+
+typedef SAMDTimerDMA SAMD_TimerDMA;
+
+class SAMDTimerDMA
+{
+  private:
+    uint8_t           _channel;
+    
+    // Callbacks for the first and second descriptor of the ring
+    timerCallback     _callback[2];
+    
+    // Descriptor being transferred now
+    volatile uint8_t  _block;
+    
+    bool _start(const uint8_t& triggerSource, const SAMDDMABeatSize& beatSize, const uint16_t& count,
+                const void* sourceA, const void* sourceB, const bool& sourceIncrement,
+                volatile void* destinationA, volatile void* destinationB, const bool& destinationIncrement,
+                timerCallback callbackA, timerCallback callbackB);
+
+  public:
+
+    SAMDTimerDMA(const uint8_t& channel = 0) : _channel(channel), _block(0)
+    {
+      _callback[0] = NULL;
+      _callback[1] = NULL;
+    };
+    
+    // Memory -> peripheral register, one beat per trigger, looping over buffer (count beats) until stop().
+    // halfCallback runs once the first half has been sent, fullCallback once the second half has. Either can be NULL.
+    // Use SAMDTimerInterrupt::setTriggerFrequency() and getDMATriggerSource() to get the trigger source
+    bool startOutput(const uint8_t& triggerSource, const void* buffer, const uint16_t& count, const SAMDDMABeatSize& beatSize,
+                     volatile void* destination, timerCallback halfCallback = NULL, timerCallback fullCallback = NULL);
+    
+    // Same, alternating between bufferA and bufferB (count beats each). The callback of a buffer runs once it has been
+    // sent, so it can be refilled while the other one is being sent
+    bool startOutputDoubleBuffer(const uint8_t& triggerSource, const void* bufferA, const void* bufferB, const uint16_t& count,
+                                 const SAMDDMABeatSize& beatSize, volatile void* destination,
+                                 timerCallback callbackA, timerCallback callbackB);
+    
+    // Peripheral register -> memory, one beat per trigger, alternating between bufferA and bufferB (count beats each).
+    // The callback of a buffer runs once it is full, so it can be processed while the other one fills
+    bool startInput(const uint8_t& triggerSource, volatile void* source, void* bufferA, void* bufferB, const uint16_t& count,
+                    const SAMDDMABeatSize& beatSize, timerCallback callbackA, timerCallback callbackB);
+    
+    void stop();
+    
+    bool isRunning();
+    
+    uint8_t getChannel()
+    {
+      return _channel;
+    }
+    
+    // Called by the DMAC handler at the end of each block
+    void handleInterrupt()
+    {
+      timerCallback callback = _callback[_block];
+      
+      _block ^= 1;
+      
+      if (callback != NULL)
+        (*callback)();
+    }
+}; // class SAMDTimerDMA
+
+#endif    // SAMD_TIMER_DMA_HPP
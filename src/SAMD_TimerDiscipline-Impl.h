@@ -0,0 +1,161 @@
+/****************************************************************************************************************************
+  SAMD_TimerDiscipline-Impl.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Timebase disciplining. A 1 PPS reference, e.g. from a GPS, is captured against the 48MHz timer clock, and a PI loop
+  on the accumulated time error estimates the clock error in ppb, with which the running hardware timers are retuned.
+  SAMD_ISR_Timer counts millis() and isn't corrected.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_DISCIPLINE_IMPL_H
+#define SAMD_TIMER_DISCIPLINE_IMPL_H
+
+SAMDTimerDiscipline* SAMD_discipline_instance = NULL;
+
+void SAMD_disciplineCapture(const uint32_t& period, const uint32_t& pulseWidth)
+{
+  (void) pulseWidth;
+  
+  SAMD_discipline_instance->handlePulse(period);
+}
+
+////////////////////////////////////////////////////////
+
+void SAMDTimerDiscipline::handlePulse(const uint32_t& period)
+{
+  if (_state == SAMD_DISCIPLINE_OFF)
+    return;
+    
+  if (period == 0)
+  {
+    // Keep the frequency estimate, drop the pending phase correction. The phase is unknown once the pulses come back
+    if (_acquired)
+    {
+      _state      = SAMD_DISCIPLINE_HOLDOVER;
+      _phase      = 0;
+      _lockCount  = 0;
+      
+      SAMD_setClockError((int32_t) _frequency);
+    }
+    
+    return;
+  }
+  
+  // Each period is 1s of reference time, so ppb of clock error are also ns of time error
+  float measured = ((float) period - _tickHz) * (1e9f / _tickHz);
+  
+  _measured = (int32_t) measured;
+  _pulseCount++;
+  
+  if (!_acquired)
+  {
+    if ( (measured > SAMD_DISCIPLINE_MAX_ERROR_PPB) || (measured < -SAMD_DISCIPLINE_MAX_ERROR_PPB) )
+    {
+      _rejectCount++;
+      return;
+    }
+    
+    // Coarse frequency from the first pulse, so the loop only has the residual to track
+    _acquired   = true;
+    _frequency  = measured;
+    _phase      = 0;
+    _state      = SAMD_DISCIPLINE_ACQUIRING;
+    
+    SAMD_setClockError((int32_t) _frequency);
+    
+    return;
+  }
+  
+  float residual = measured - SAMD_getClockError();
+  
+  if ( (residual > SAMD_DISCIPLINE_MAX_STEP_PPB) || (residual < -SAMD_DISCIPLINE_MAX_STEP_PPB) )
+  {
+    _rejectCount++;
+    
+    // Not a glitch if it lasts, e.g. the clock was retuned. Acquire again from the next pulse
+    if (++_rejectRun >= SAMD_DISCIPLINE_LOCK_COUNT)
+    {
+      _acquired   = false;
+      _rejectRun  = 0;
+      _lockCount  = 0;
+      _state      = SAMD_DISCIPLINE_ACQUIRING;
+    }
+    
+    return;
+  }
+  
+  _rejectRun = 0;
+  
+  // Type 2 loop: the integral of the time error tracks a constant frequency error with no residual time error
+  _phase     += residual;
+  _frequency += _ki * _phase;
+  
+  SAMD_setClockError((int32_t) (_frequency + _kp * _phase));
+  
+  if ( (_phase < SAMD_DISCIPLINE_LOCK_NS) && (_phase > -SAMD_DISCIPLINE_LOCK_NS) )
+  {
+    if (_lockCount < SAMD_DISCIPLINE_LOCK_COUNT)
+      _lockCount++;
+  }
+  else
+    _lockCount = 0;
+    
+  _state = (_lockCount == SAMD_DISCIPLINE_LOCK_COUNT) ? SAMD_DISCIPLINE_LOCKED : SAMD_DISCIPLINE_ACQUIRING;
+}
+
+bool SAMDTimerDiscipline::begin(const uint32_t& tickHz)
+{
+  if (tickHz == 0)
+    return false;
+    
+  _tickHz       = tickHz;
+  _phase        = 0;
+  _frequency    = 0;
+  _acquired     = false;
+  _lockCount    = 0;
+  _rejectRun    = 0;
+  _measured     = 0;
+  _pulseCount   = 0;
+  _rejectCount  = 0;
+  _state        = SAMD_DISCIPLINE_ACQUIRING;
+  
+  return true;
+}
+
+bool SAMDTimerDiscipline::begin(SAMDTimerCapture& capture, const uint8_t& pin)
+{
+  end();
+  
+  SAMD_discipline_instance = this;
+  
+  // Room for a late pulse. A missed one is caught by the range check
+  if (!capture.begin(pin, SAMD_disciplineCapture, 1500000))
+    return false;
+  
+  _capture = &capture;
+  
+  TISR_LOGDEBUG1(F("SAMDTimerDiscipline: tick Hz ="), capture.getTickFrequency());
+  
+  return begin(capture.getTickFrequency());
+}
+
+void SAMDTimerDiscipline::end()
+{
+  _state = SAMD_DISCIPLINE_OFF;
+  
+  if (_capture != NULL)
+  {
+    _capture->end();
+    _capture = NULL;
+  }
+}
+
+#endif    // SAMD_TIMER_DISCIPLINE_IMPL_H
@@ -0,0 +1,24 @@
+/****************************************************************************************************************************
+  SAMD_TimerDiscipline.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Timebase disciplining. A 1 PPS reference, e.g. from a GPS, is captured against the 48MHz timer clock, and a PI loop
+  on the accumulated time error estimates the clock error in ppb, which the period math of every timer then corrects.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_DISCIPLINE_H
+#define SAMD_TIMER_DISCIPLINE_H
+
+#include "SAMD_TimerCapture.h"
+#include "SAMD_TimerDiscipline.hpp"
+#include "SAMD_TimerDiscipline-Impl.h"
+
+#endif    // SAMD_TIMER_DISCIPLINE_H
@@ -0,0 +1,125 @@
+/****************************************************************************************************************************
+  SAMD_TimerDiscipline.hpp
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Timebase disciplining. A 1 PPS reference, e.g. from a GPS, is captured against the 48MHz timer clock, and a PI loop
+  on the accumulated time error estimates the clock error in ppb, with which the running hardware timers are retuned.
+  SAMD_ISR_Timer counts millis() and isn't corrected.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_DISCIPLINE_HPP
+#define SAMD_TIMER_DISCIPLINE_HPP
+
+#include "SAMDTimerInterrupt.hpp"
+#include "SAMD_TimerCapture.hpp"
+
+// Widest clock error accepted while acquiring, 5%. An open-loop DFLL48M is within 1-2%
+#define SAMD_DISCIPLINE_MAX_ERROR_PPB     50000000L
+
+// Once acquired, a pulse further than this from the estimate is dropped as a glitch or a missed pulse
+#define SAMD_DISCIPLINE_MAX_STEP_PPB      100000L
+
+// Locked after this many pulses in a row with the time error below SAMD_DISCIPLINE_LOCK_NS
+#define SAMD_DISCIPLINE_LOCK_COUNT        8
+#define SAMD_DISCIPLINE_LOCK_NS           2000
+
+typedef enum
+{
+  SAMD_DISCIPLINE_OFF       = 0,
+  SAMD_DISCIPLINE_ACQUIRING = 1,    // waiting for pulses, or converging
+  SAMD_DISCIPLINE_LOCKED    = 2,
+  SAMD_DISCIPLINE_HOLDOVER  = 3,    // reference lost, the last frequency estimate stays applied
+} SAMDDisciplineState;
+
+class SAMDTimerDiscipline;
+
+typedef SAMDTimerDiscipline SAMD_TimerDiscipline;
+
+class SAMDTimerDiscipline
+{
+  private:
+    SAMDTimerCapture*   _capture;
+    uint32_t            _tickHz;
+    
+    float               _kp;
+    float               _ki;
+    
+    float               _phase;         // accumulated time error (ns) since acquisition
+    float               _frequency;     // integral term, the clock error estimate (ppb)
+    
+    bool                _acquired;
+    uint8_t             _lockCount;
+    uint8_t             _rejectRun;     // pulses rejected in a row
+    
+    volatile SAMDDisciplineState  _state;
+    volatile int32_t              _measured;      // clock error (ppb) of the last pulse alone
+    volatile uint32_t             _pulseCount;
+    volatile uint32_t             _rejectCount;
+
+  public:
+  
+    // Loop gains per pulse. The defaults settle within about 30 pulses, and average the capture quantization and the
+    // reference jitter down to a few tens of ppb
+    SAMDTimerDiscipline(const float& kp = 0.2f, const float& ki = 0.02f)
+      : _capture(NULL), _tickHz(0), _kp(kp), _ki(ki), _phase(0), _frequency(0), _acquired(false), _lockCount(0),
+        _rejectRun(0), _state(SAMD_DISCIPLINE_OFF), _measured(0), _pulseCount(0), _rejectCount(0)
+    {
+    };
+    
+    // Discipline the timers with the 1 PPS signal on 'pin', which must be an external interrupt pin. 'capture' is
+    // dedicated to it
+    bool begin(SAMDTimerCapture& capture, const uint8_t& pin);
+    
+    // Without capture: feed handlePulse() from another source, such as a simulation, with periods in ticks of 'tickHz'
+    bool begin(const uint32_t& tickHz);
+    
+    // Stop the loop and the capture. The last correction stays applied
+    void end();
+    
+    SAMDDisciplineState getState()
+    {
+      return _state;
+    }
+    
+    // Correction in use, SAMD_clockErrorPpb
+    int32_t getCorrection()
+    {
+      return SAMD_getClockError();
+    }
+    
+    // Clock error (ppb) measured on the last pulse alone, before filtering
+    int32_t getMeasuredError()
+    {
+      return _measured;
+    }
+    
+    // Time error (ns) the loop is still correcting
+    float getPhaseError()
+    {
+      return _phase;
+    }
+    
+    uint32_t getPulseCount()
+    {
+      return _pulseCount;
+    }
+    
+    // Pulses dropped as too far from the estimate
+    uint32_t getRejectCount()
+    {
+      return _rejectCount;
+    }
+    
+    // One reference period, in ticks. 0 => reference lost, go to holdover. Called by the capture interrupt
+    void handlePulse(const uint32_t& period);
+}; // class SAMDTimerDiscipline
+
+#endif    // SAMD_TIMER_DISCIPLINE_HPP
@@ -0,0 +1,111 @@
+/****************************************************************************************************************************
+  SAMD_TimerEventSystem.hpp
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Minimal Event System (EVSYS) routing, used to connect a timer event to another peripheral with no CPU involvement.
+  Only the asynchronous path is used, so no GCLK is needed for the channel and no EVSYS interrupt is generated.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_EVENT_SYSTEM_HPP
+#define SAMD_TIMER_EVENT_SYSTEM_HPP
+
+#include "SAMDTimerInterrupt.hpp"
+
+#define SAMD_EVSYS_NUM_CHANNELS     EVSYS_CHANNELS
+
+// Route event generator 'generator' (EVSYS_ID_GEN_xxx) to event user 'user' (EVSYS_ID_USER_xxx) through 'channel'.
+// A channel can feed several users, but each user listens to one channel only
+static inline bool SAMD_EVSYS_connect(const uint8_t& channel, const uint8_t& generator, const uint8_t& user)
+{
+  if (channel >= SAMD_EVSYS_NUM_CHANNELS)
+    return false;
+    
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  MCLK->APBBMASK.reg |= MCLK_APBBMASK_EVSYS;
+  
+  // Users must be set up before the channel. USER.CHANNEL is channel number + 1, 0 => not connected
+  EVSYS->USER[user].reg = EVSYS_USER_CHANNEL(channel + 1);
+  
+  EVSYS->Channel[channel].CHANNEL.reg = EVSYS_CHANNEL_EVGEN(generator) | EVSYS_CHANNEL_PATH_ASYNCHRONOUS;
+  
+#else
+
+  PM->APBCMASK.reg |= PM_APBCMASK_EVSYS;
+  
+  // Users must be set up before the channel. USER.CHANNEL is channel number + 1, 0 => not connected
+  EVSYS->USER.reg = (uint16_t) (EVSYS_USER_USER(user) | EVSYS_USER_CHANNEL(channel + 1));
+  
+  EVSYS->CHANNEL.reg = EVSYS_CHANNEL_CHANNEL(channel) | EVSYS_CHANNEL_EVGEN(generator) | EVSYS_CHANNEL_PATH_ASYNCHRONOUS;
+  
+#endif
+
+  TISR_LOGDEBUG3(F("SAMD_EVSYS_connect: channel ="), channel, F(", generator ="), generator);
+  
+  return true;
+}
+
+// Detach 'user' from its channel, and stop the channel
+static inline void SAMD_EVSYS_disconnect(const uint8_t& channel, const uint8_t& user)
+{
+  if (channel >= SAMD_EVSYS_NUM_CHANNELS)
+    return;
+    
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  EVSYS->USER[user].reg = 0;
+  EVSYS->Channel[channel].CHANNEL.reg = 0;
+#else
+  EVSYS->USER.reg     = (uint16_t) EVSYS_USER_USER(user);
+  EVSYS->CHANNEL.reg  = EVSYS_CHANNEL_CHANNEL(channel);
+#endif
+}
+
+////////////////////////////////////////////////////
+
+// attachInterrupt() is only used to let the core mux the pin and set up its EIC line
+static void SAMD_EIC_noCallback()
+{
+}
+
+// Mux 'pin' to its EIC line with the given sense (RISING, HIGH, etc.), and make the line generate events instead of
+// CPU interrupts. Returns the EXTINT line, to be routed from EVSYS_ID_GEN_EIC_EXTINT_0 + line, or -1 if there is none
+static inline int8_t SAMD_EIC_enableEvent(const uint8_t& pin, const uint32_t& mode)
+{
+  if (g_APinDescription[pin].ulExtInt == NOT_AN_INTERRUPT)
+    return -1;
+    
+  uint8_t extInt = g_APinDescription[pin].ulExtInt;
+  
+  attachInterrupt(digitalPinToInterrupt(pin), SAMD_EIC_noCallback, mode);
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  // EIC EVCTRL is enable-protected
+  EIC->CTRLA.reg &= ~EIC_CTRLA_ENABLE;
+  while (EIC->SYNCBUSY.bit.ENABLE);
+  
+  EIC->EVCTRL.reg   |= EIC_EVCTRL_EXTINTEO(1 << extInt);
+  EIC->INTENCLR.reg  = EIC_INTENCLR_EXTINT(1 << extInt);
+  
+  EIC->CTRLA.reg |= EIC_CTRLA_ENABLE;
+  while (EIC->SYNCBUSY.bit.ENABLE);
+  
+#else
+
+  EIC->EVCTRL.reg   |= EIC_EVCTRL_EXTINTEO(1 << extInt);
+  EIC->INTENCLR.reg  = EIC_INTENCLR_EXTINT(1 << extInt);
+  
+#endif
+
+  return extInt;
+}
+
+#endif    // SAMD_TIMER_EVENT_SYSTEM_HPP
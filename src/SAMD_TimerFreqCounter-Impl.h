@@ -0,0 +1,172 @@
+/****************************************************************************************************************************
+  SAMD_TimerFreqCounter-Impl.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Gated frequency counter. Pin edges go from the EIC through EVSYS to the 32-bit TC4/TC5 pair counting events, and a
+  SAMDTimerInterrupt timer defines the gate, so the CPU is interrupted once per gate whatever the input frequency.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_FREQ_COUNTER_IMPL_H
+#define SAMD_TIMER_FREQ_COUNTER_IMPL_H
+
+SAMDTimerFreqCounter* SAMD_freqCounter_instance = NULL;
+
+void SAMD_freqCounterGate()
+{
+  SAMD_freqCounter_instance->handleGate();
+}
+
+////////////////////////////////////////////////////////
+
+uint32_t SAMDTimerFreqCounter::readCount()
+{
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  SAMD_FREQ_COUNTER_TC->COUNT32.CTRLBSET.reg = TC_CTRLBSET_CMD_READSYNC;
+  while (SAMD_FREQ_COUNTER_TC->COUNT32.SYNCBUSY.bit.CTRLB);
+  while (SAMD_FREQ_COUNTER_TC->COUNT32.CTRLBSET.bit.CMD);
+  while (SAMD_FREQ_COUNTER_TC->COUNT32.SYNCBUSY.bit.COUNT);
+#else
+  SAMD_FREQ_COUNTER_TC->COUNT32.READREQ.reg = TC_READREQ_RREQ | TC_READREQ_ADDR(0x10);
+  while (SAMD_FREQ_COUNTER_TC->COUNT32.STATUS.bit.SYNCBUSY);
+#endif
+
+  return SAMD_FREQ_COUNTER_TC->COUNT32.COUNT.reg;
+}
+
+void SAMDTimerFreqCounter::handleGate()
+{
+  uint32_t count = readCount();
+  
+  // Unsigned difference stays right across the 32-bit wrap
+  uint32_t edges = count - _lastCount;
+  
+  _lastCount = count;
+  
+  if (_gateCount++ == 0)
+  {
+    // The first gate started at an arbitrary time
+    return;
+  }
+  
+  _count = edges;
+  
+  // The timers were retuned for a new clock correction, SAMDTimerDiscipline or SAMD_calibrateClock()
+  if (_clockError != SAMD_clockErrorPpb)
+  {
+    _clockError = SAMD_clockErrorPpb;
+    _gateTime   = _gateTimer->getPeriod();
+  }
+  
+  if (_callback != NULL)
+    (*_callback)(edges * 1000000.0f / _gateTime);
+}
+
+bool SAMDTimerFreqCounter::begin(SAMDTimerInterrupt& gateTimer, const uint8_t& pin, const float& gateTime, 
+                                 frequencyCallback callback)
+{
+  end();
+  
+  if ( (gateTime <= 0) || (gateTime > gateTimer.getMaxPeriod()) )
+  {
+    TISR_LOGWARN1(F("SAMDTimerFreqCounter: gateTime out of range, max ="), gateTimer.getMaxPeriod());
+    
+    return false;
+  }
+  
+  int8_t extInt = SAMD_EIC_enableEvent(pin, RISING);
+  
+  if (extInt < 0)
+    return false;
+    
+  _gateTimer  = &gateTimer;
+  _callback   = callback;
+  _count      = 0;
+  _gateCount  = 0;
+  
+  SAMD_freqCounter_instance = this;
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  MCLK->APBCMASK.reg |= MCLK_APBCMASK_TC4 | MCLK_APBCMASK_TC5;
+  
+  GCLK->PCHCTRL[TC4_GCLK_ID].reg = GCLK_PCHCTRL_GEN_GCLK1 | GCLK_PCHCTRL_CHEN;
+  while (GCLK->SYNCBUSY.reg > 0);
+  
+  SAMD_FREQ_COUNTER_TC->COUNT32.CTRLA.reg = TC_CTRLA_SWRST;
+  while (SAMD_FREQ_COUNTER_TC->COUNT32.SYNCBUSY.bit.SWRST);
+  
+  SAMD_FREQ_COUNTER_TC->COUNT32.CTRLA.reg   = TC_CTRLA_MODE_COUNT32 | TC_CTRLA_PRESCALER_DIV1;
+  SAMD_FREQ_COUNTER_TC->COUNT32.EVCTRL.reg  = TC_EVCTRL_TCEI | TC_EVCTRL_EVACT_COUNT;
+  
+  SAMD_FREQ_COUNTER_TC->COUNT32.CTRLA.reg |= TC_CTRLA_ENABLE;
+  while (SAMD_FREQ_COUNTER_TC->COUNT32.SYNCBUSY.bit.ENABLE);
+  
+#else
+
+  PM->APBCMASK.reg |= PM_APBCMASK_TC4 | PM_APBCMASK_TC5;
+  
+  REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID(GCM_TC4_TC5));
+  while ( GCLK->STATUS.bit.SYNCBUSY == 1 );
+  
+  SAMD_FREQ_COUNTER_TC->COUNT32.CTRLA.reg = TC_CTRLA_SWRST;
+  while (SAMD_FREQ_COUNTER_TC->COUNT32.CTRLA.bit.SWRST);
+  
+  SAMD_FREQ_COUNTER_TC->COUNT32.CTRLA.reg   = TC_CTRLA_MODE_COUNT32 | TC_CTRLA_PRESCALER_DIV1;
+  SAMD_FREQ_COUNTER_TC->COUNT32.EVCTRL.reg  = TC_EVCTRL_TCEI | TC_EVCTRL_EVACT_COUNT;
+  
+  SAMD_FREQ_COUNTER_TC->COUNT32.CTRLA.reg |= TC_CTRLA_ENABLE;
+  while (SAMD_FREQ_COUNTER_TC->COUNT32.STATUS.bit.SYNCBUSY);
+  
+#endif
+
+  // EIC EXTINT n -> EVSYS -> TC4 event input
+  SAMD_EVSYS_connect(_eventChannel, EVSYS_ID_GEN_EIC_EXTINT_0 + extInt, EVSYS_ID_USER_TC4_EVU);
+  
+  _lastCount = readCount();
+  
+  // By frequency, as the interval variant takes whole us
+  if (!gateTimer.attachInterrupt(1000000.0f / gateTime, SAMD_freqCounterGate))
+  {
+    end();
+    return false;
+  }
+  
+  // The programmed gate differs from the requested one by the CC / PER truncation
+  _clockError = SAMD_clockErrorPpb;
+  _gateTime   = gateTimer.getPeriod();
+  
+  TISR_LOGDEBUG3(F("SAMDTimerFreqCounter: EXTINT ="), extInt, F(", gateTime ="), _gateTime);
+  
+  return true;
+}
+
+void SAMDTimerFreqCounter::end()
+{
+  if (_gateTimer == NULL)
+    return;
+    
+  _gateTimer->detachInterrupt();
+  _gateTimer->disableTimer();
+  
+  SAMD_EVSYS_disconnect(_eventChannel, EVSYS_ID_USER_TC4_EVU);
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  SAMD_FREQ_COUNTER_TC->COUNT32.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+  while (SAMD_FREQ_COUNTER_TC->COUNT32.SYNCBUSY.bit.ENABLE);
+#else
+  SAMD_FREQ_COUNTER_TC->COUNT32.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+  while (SAMD_FREQ_COUNTER_TC->COUNT32.STATUS.bit.SYNCBUSY);
+#endif
+
+  _gateTimer = NULL;
+}
+
+#endif    // SAMD_TIMER_FREQ_COUNTER_IMPL_H
@@ -0,0 +1,23 @@
+/****************************************************************************************************************************
+  SAMD_TimerFreqCounter.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Gated frequency counter. Pin edges go from the EIC through EVSYS to the 32-bit TC4/TC5 pair counting events, and a
+  SAMDTimerInterrupt timer defines the gate, so the CPU is interrupted once per gate whatever the input frequency.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_FREQ_COUNTER_H
+#define SAMD_TIMER_FREQ_COUNTER_H
+
+#include "SAMD_TimerFreqCounter.hpp"
+#include "SAMD_TimerFreqCounter-Impl.h"
+
+#endif    // SAMD_TIMER_FREQ_COUNTER_H
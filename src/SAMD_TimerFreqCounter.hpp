@@ -0,0 +1,94 @@
+/****************************************************************************************************************************
+  SAMD_TimerFreqCounter.hpp
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Gated frequency counter. Pin edges go from the EIC through EVSYS to the 32-bit TC4/TC5 pair counting events, and a
+  SAMDTimerInterrupt timer defines the gate, so the CPU is interrupted once per gate whatever the input frequency.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_FREQ_COUNTER_HPP
+#define SAMD_TIMER_FREQ_COUNTER_HPP
+
+#include "SAMDTimerInterrupt.hpp"
+#include "SAMD_TimerEventSystem.hpp"
+
+// TC4 is the master of the 32-bit TC4/TC5 pair, so neither can be used for anything else
+#if !defined(TC4) || !defined(TC5)
+  #error SAMDTimerFreqCounter needs TC4 and TC5
+#endif
+
+#define SAMD_FREQ_COUNTER_TC          TC4
+
+// Called once per gate, in the gate timer interrupt, with the measured frequency (Hz)
+typedef void (*frequencyCallback) (const float& frequency);
+
+class SAMDTimerFreqCounter;
+
+typedef SAMDTimerFreqCounter SAMD_TimerFreqCounter;
+
+class SAMDTimerFreqCounter
+{
+  private:
+    uint8_t             _eventChannel;
+    
+    SAMDTimerInterrupt* _gateTimer;
+    float               _gateTime;      // gate (us) the timer really programmed, not the requested one
+    int32_t             _clockError;    // SAMD_clockErrorPpb _gateTime was computed with
+    
+    frequencyCallback   _callback;
+    
+    uint32_t            _lastCount;
+    
+    volatile uint32_t   _count;
+    volatile uint32_t   _gateCount;
+    
+    uint32_t readCount();
+
+  public:
+  
+    SAMDTimerFreqCounter(const uint8_t& eventChannel = 2)
+      : _eventChannel(eventChannel), _gateTimer(NULL), _gateTime(1000000), _clockError(0), _callback(NULL), 
+        _lastCount(0), _count(0), _gateCount(0)
+    {
+    };
+    
+    // Count the rising edges on 'pin', which must be an external interrupt pin, over gates of 'gateTime' us timed by
+    // 'gateTimer'. The counter is never reset, so the gate timer interrupt latency does not add up from gate to gate.
+    // Input frequency up to a few MHz. 'gateTime' is limited by the gate timer, see SAMDTimerInterrupt::getMaxPeriod():
+    // about 1.39s with TC3 (16-bit at DIV1024 of 48MHz), returns false beyond
+    bool begin(SAMDTimerInterrupt& gateTimer, const uint8_t& pin, const float& gateTime = 1000000, 
+               frequencyCallback callback = NULL);
+    
+    void end();
+    
+    // Edges counted during the last gate
+    uint32_t getCount()
+    {
+      return _count;
+    }
+    
+    // Frequency (Hz) over the last gate, from the gate the timer really achieved
+    float getFrequency()
+    {
+      return _count * 1000000.0f / _gateTime;
+    }
+    
+    // Number of gates completed since begin()
+    uint32_t getGateCount()
+    {
+      return _gateCount;
+    }
+    
+    // Called by the gate timer
+    void handleGate();
+}; // class SAMDTimerFreqCounter
+
+#endif    // SAMD_TIMER_FREQ_COUNTER_HPP
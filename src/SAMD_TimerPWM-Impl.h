@@ -0,0 +1,291 @@
+/****************************************************************************************************************************
+  SAMD_TimerPWM-Impl.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Hardware PWM on TCC0. Single-slope (NPWM) or center-aligned dual-slope (DSBOTTOM) PWM on every TCC0 output pin,
+  with dead-time insertion for half-bridges and duty / frequency changes buffered to the next period boundary.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_PWM_IMPL_H
+#define SAMD_TIMER_PWM_IMPL_H
+
+uint32_t SAMDTimerPWM::frequencyToTop(const float& frequency, const uint8_t& prescalerIndex)
+{
+  float ticks = TIMER_HZ / (SAMD_prescalerDivider[prescalerIndex] * frequency);
+  float top   = (_mode == SAMD_PWM_SINGLE_SLOPE) ? ticks - 1 : ticks / 2;
+  
+  if ( (top < 2) || (top > SAMD_PWM_MAX_COUNT) )
+    return 0;
+    
+  return (uint32_t) (top + 0.5f);
+}
+
+void SAMDTimerPWM::writeWEXCTRL()
+{
+  // WEXCTRL is enable-protected
+  SAMD_PWM_TCC->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+  while (SAMD_PWM_TCC->SYNCBUSY.bit.ENABLE);
+  
+  SAMD_PWM_TCC->WEXCTRL.reg = _wexctrl;
+  
+  SAMD_PWM_TCC->CTRLA.reg |= TCC_CTRLA_ENABLE;
+  while (SAMD_PWM_TCC->SYNCBUSY.bit.ENABLE);
+}
+
+bool SAMDTimerPWM::begin(const float& frequency, const SAMDPWMMode& mode)
+{
+  if (frequency <= 0)
+    return false;
+    
+  end();
+  
+  _mode = mode;
+  _top  = 0;
+  
+  for (_prescalerIndex = 0; _prescalerIndex < 8; _prescalerIndex++)
+  {
+    _top = frequencyToTop(frequency, _prescalerIndex);
+    
+    if (_top != 0)
+      break;
+  }
+  
+  if (_top == 0)
+  {
+    TISR_LOGERROR1(F("SAMDTimerPWM: frequency out of range ="), frequency);
+    
+    return false;
+  }
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  MCLK->APBBMASK.reg |= MCLK_APBBMASK_TCC0;
+  
+  GCLK->PCHCTRL[TCC0_GCLK_ID].reg = GCLK_PCHCTRL_GEN_GCLK1 | GCLK_PCHCTRL_CHEN;
+  while (GCLK->SYNCBUSY.reg > 0);
+  
+#else
+
+  PM->APBCMASK.reg |= PM_APBCMASK_TCC0;
+  
+  REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID(GCM_TCC0_TCC1));
+  while ( GCLK->STATUS.bit.SYNCBUSY == 1 );
+  
+#endif
+
+  SAMD_PWM_TCC->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+  while (SAMD_PWM_TCC->SYNCBUSY.bit.ENABLE);
+  
+  SAMD_PWM_TCC->CTRLA.reg = TCC_CTRLA_SWRST;
+  while (SAMD_PWM_TCC->SYNCBUSY.bit.SWRST);
+  
+  SAMD_PWM_TCC->CTRLA.reg   = TCC_CTRLA_PRESCALER(_prescalerIndex) | TCC_CTRLA_PRESCSYNC_PRESC;
+  SAMD_PWM_TCC->WEXCTRL.reg = _wexctrl;
+  
+  SAMD_PWM_TCC->WAVE.reg = (_mode == SAMD_PWM_SINGLE_SLOPE) ? TCC_WAVE_WAVEGEN_NPWM : TCC_WAVE_WAVEGEN_DSBOTTOM;
+  while (SAMD_PWM_TCC->SYNCBUSY.bit.WAVE);
+  
+  SAMD_PWM_TCC->PER.reg = _top;
+  while (SAMD_PWM_TCC->SYNCBUSY.bit.PER);
+  
+  for (uint8_t channel = 0; channel < SAMD_PWM_NUM_CHANNELS; channel++)
+  {
+    _duty[channel] = 0;
+    
+    SAMD_PWM_TCC->CC[channel].reg = 0;
+    while (SAMD_PWM_TCC->SYNCBUSY.reg & (TCC_SYNCBUSY_CC0 << channel));
+  }
+  
+  SAMD_PWM_TCC->CTRLA.reg |= TCC_CTRLA_ENABLE;
+  while (SAMD_PWM_TCC->SYNCBUSY.bit.ENABLE);
+  
+  _running    = true;
+  _updateLock = 0;
+  
+  TISR_LOGDEBUG3(F("SAMDTimerPWM: prescaler ="), SAMD_prescalerDivider[_prescalerIndex], F(", TOP ="), _top);
+  
+  return true;
+}
+
+void SAMDTimerPWM::end()
+{
+  if (!_running)
+    return;
+    
+  SAMD_PWM_TCC->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+  while (SAMD_PWM_TCC->SYNCBUSY.bit.ENABLE);
+  
+  _running    = false;
+  _updateLock = 0;
+}
+
+int8_t SAMDTimerPWM::attachPin(const uint8_t& pin)
+{
+  if (pin >= PINS_COUNT)
+    return -1;
+    
+  const PinDescription& pinDesc = g_APinDescription[pin];
+  
+  if ( (pinDesc.ulPWMChannel == NOT_ON_PWM) || (GetTCNumber(pinDesc.ulPWMChannel) != 0) )
+    return -1;
+    
+  uint32_t attr = pinDesc.ulPinAttribute;
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  if (attr & PIN_ATTR_PWM_E)
+    pinPeripheral(pin, PIO_TIMER);
+  else if (attr & PIN_ATTR_PWM_F)
+    pinPeripheral(pin, PIO_TIMER_ALT);
+  else if (attr & PIN_ATTR_PWM_G)
+    pinPeripheral(pin, PIO_TCC_PDEC);
+  else
+    return -1;
+    
+#else
+
+  if (attr & PIN_ATTR_TIMER)
+    pinPeripheral(pin, PIO_TIMER);
+  else if (attr & PIN_ATTR_TIMER_ALT)
+    pinPeripheral(pin, PIO_TIMER_ALT);
+  else
+    return -1;
+    
+#endif
+
+  return GetTCChannelNumber(pinDesc.ulPWMChannel) % SAMD_PWM_NUM_CHANNELS;
+}
+
+bool SAMDTimerPWM::setDutyTicks(const uint8_t& channel, const uint32_t& ticks)
+{
+  if ( !_running || (channel >= SAMD_PWM_NUM_CHANNELS) )
+    return false;
+    
+  // Same full scale as dutyToTicks(). Above it the output is stuck or undefined, and the dead-time pair breaks
+  uint32_t fullScale = (_mode == SAMD_PWM_SINGLE_SLOPE) ? _top + 1 : _top;
+  
+  if (ticks > fullScale)
+    return false;
+    
+  // Latched into CC at the next UPDATE, i.e. the end of the running period
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  SAMD_PWM_TCC->CCBUF[channel].reg = ticks;
+#else
+  while (SAMD_PWM_TCC->SYNCBUSY.reg & (TCC_SYNCBUSY_CCB0 << channel));
+  
+  SAMD_PWM_TCC->CCB[channel].reg = ticks;
+#endif
+
+  return true;
+}
+
+bool SAMDTimerPWM::setDuty(const uint8_t& channel, const float& duty)
+{
+  if ( (channel >= SAMD_PWM_NUM_CHANNELS) || (duty < 0) || (duty > 100) )
+    return false;
+    
+  if (!setDutyTicks(channel, dutyToTicks(duty)))
+    return false;
+    
+  _duty[channel] = duty;
+  
+  return true;
+}
+
+bool SAMDTimerPWM::setFrequency(const float& frequency)
+{
+  if ( !_running || (frequency <= 0) )
+    return false;
+    
+  uint32_t top = frequencyToTop(frequency, _prescalerIndex);
+  
+  if (top == 0)
+    return false;
+    
+  _top = top;
+  
+  // PER and CC buffers are latched together at the same UPDATE. Without the lock, an UPDATE between the writes
+  // would run one period with the new TOP and the old CCs, fully on or off when the period shrinks
+  lockUpdate();
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  SAMD_PWM_TCC->PERBUF.reg = _top;
+#else
+  while (SAMD_PWM_TCC->SYNCBUSY.bit.PERB);
+  
+  SAMD_PWM_TCC->PERB.reg = _top;
+#endif
+
+  for (uint8_t channel = 0; channel < SAMD_PWM_NUM_CHANNELS; channel++)
+    setDutyTicks(channel, dutyToTicks(_duty[channel]));
+    
+  unlockUpdate();
+  
+  return true;
+}
+
+void SAMDTimerPWM::lockUpdate()
+{
+  if ( !_running || (_updateLock++ != 0) )
+    return;
+    
+  SAMD_PWM_TCC->CTRLBSET.reg = TCC_CTRLBSET_LUPD;
+  while (SAMD_PWM_TCC->SYNCBUSY.bit.CTRLB);
+}
+
+void SAMDTimerPWM::unlockUpdate()
+{
+  if ( !_running || (_updateLock == 0) || (--_updateLock != 0) )
+    return;
+    
+#if !(TIMER_INTERRUPT_USING_SAMD51)
+  // A PERB / CCBx write still synchronizing would miss the UPDATE that the unlock lets through
+  while (SAMD_PWM_TCC->SYNCBUSY.bit.PERB);
+  
+  for (uint8_t channel = 0; channel < SAMD_PWM_NUM_CHANNELS; channel++)
+    while (SAMD_PWM_TCC->SYNCBUSY.reg & (TCC_SYNCBUSY_CCB0 << channel));
+#endif
+
+  SAMD_PWM_TCC->CTRLBCLR.reg = TCC_CTRLBCLR_LUPD;
+  while (SAMD_PWM_TCC->SYNCBUSY.bit.CTRLB);
+}
+
+bool SAMDTimerPWM::setDeadTime(const uint8_t& channel, const float& lowSide, const float& highSide)
+{
+  if ( (channel >= SAMD_PWM_NUM_DTI_CHANNELS) || (lowSide < 0) || (highSide < 0) )
+    return false;
+    
+  // Dead time counts GCLK_TCC cycles, before the prescaler
+  uint32_t lowTicks   = (uint32_t) (lowSide  * (TIMER_HZ / 1000000000.0f) + 0.5f);
+  uint32_t highTicks  = (uint32_t) (highSide * (TIMER_HZ / 1000000000.0f) + 0.5f);
+  
+  if ( (lowTicks > 0xFF) || (highTicks > 0xFF) )
+    return false;
+    
+  if ( (lowTicks == 0) && (highTicks == 0) )
+  {
+    _wexctrl &= ~(TCC_WEXCTRL_DTIEN0 << channel);
+  }
+  else
+  {
+    _wexctrl = (_wexctrl & ~(TCC_WEXCTRL_DTLS_Msk | TCC_WEXCTRL_DTHS_Msk)) | TCC_WEXCTRL_DTIEN0 << channel
+               | TCC_WEXCTRL_DTLS(lowTicks) | TCC_WEXCTRL_DTHS(highTicks);
+  }
+  
+  if (_running)
+    writeWEXCTRL();
+  
+  TISR_LOGDEBUG3(F("SAMDTimerPWM: dead time LS ticks ="), lowTicks, F(", HS ticks ="), highTicks);
+  
+  return true;
+}
+
+#endif    // SAMD_TIMER_PWM_IMPL_H
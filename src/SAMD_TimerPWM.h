@@ -0,0 +1,23 @@
+/****************************************************************************************************************************
+  SAMD_TimerPWM.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Hardware PWM on TCC0. Single-slope (NPWM) or center-aligned dual-slope (DSBOTTOM) PWM on every TCC0 output pin,
+  with dead-time insertion for half-bridges and duty / frequency changes buffered to the next period boundary.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_PWM_H
+#define SAMD_TIMER_PWM_H
+
+#include "SAMD_TimerPWM.hpp"
+#include "SAMD_TimerPWM-Impl.h"
+
+#endif    // SAMD_TIMER_PWM_H
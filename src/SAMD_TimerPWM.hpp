@@ -0,0 +1,129 @@
+/****************************************************************************************************************************
+  SAMD_TimerPWM.hpp
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Hardware PWM on TCC0. Single-slope (NPWM) or center-aligned dual-slope (DSBOTTOM) PWM on every TCC0 output pin,
+  with dead-time insertion for half-bridges and duty / frequency changes buffered to the next period boundary.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_PWM_HPP
+#define SAMD_TIMER_PWM_HPP
+
+#include "SAMDTimerInterrupt.hpp"
+#include "wiring_private.h"
+
+// TCC0 is used for PWM. It can't be used by SAMDTimer(TIMER_TCC) or analogWrite() on its pins at the same time, and
+// on SAMD21 it shares its GCLK channel with TCC1, so both must run from the same 48MHz generator
+#define SAMD_PWM_TCC                  TCC0
+#define SAMD_PWM_MAX_COUNT            0xFFFFFF
+
+// CC channels. Output WO[n] follows channel n % SAMD_PWM_NUM_CHANNELS
+#define SAMD_PWM_NUM_CHANNELS         TCC0_CC_NUM
+
+// Channels 0-3 have dead-time insertion. With it, WO[n] is the low side and WO[n + 4] the complementary high side
+#define SAMD_PWM_NUM_DTI_CHANNELS     4
+
+typedef enum
+{
+  SAMD_PWM_SINGLE_SLOPE = 0,      // NPWM, edge-aligned
+  SAMD_PWM_DUAL_SLOPE             // DSBOTTOM, center-aligned, half the maximum frequency
+} SAMDPWMMode;
+
+class SAMDTimerPWM;
+
+typedef SAMDTimerPWM SAMD_TimerPWM;
+
+class SAMDTimerPWM
+{
+  private:
+    SAMDPWMMode   _mode;
+    uint8_t       _prescalerIndex;
+    uint32_t      _top;
+    bool          _running;
+    
+    // lockUpdate() nesting depth. CTRLB.LUPD is set while > 0
+    uint8_t       _updateLock;
+    
+    // Shared by all dead-time channels
+    uint32_t      _wexctrl;
+    
+    float         _duty[SAMD_PWM_NUM_CHANNELS];
+    
+    uint32_t dutyToTicks(const float& duty)
+    {
+      // NPWM counts TOP + 1 ticks per period, DSBOTTOM 2 * TOP
+      uint32_t fullScale = (_mode == SAMD_PWM_SINGLE_SLOPE) ? _top + 1 : _top;
+      
+      return (uint32_t) (fullScale * duty / 100.0f + 0.5f);
+    }
+    
+    // TOP for 'frequency' with the given prescaler, 0 if out of range
+    uint32_t frequencyToTop(const float& frequency, const uint8_t& prescalerIndex);
+    
+    void writeWEXCTRL();
+
+  public:
+  
+    SAMDTimerPWM() : _mode(SAMD_PWM_SINGLE_SLOPE), _prescalerIndex(0), _top(0), _running(false), _updateLock(0), _wexctrl(0)
+    {
+      for (uint8_t channel = 0; channel < SAMD_PWM_NUM_CHANNELS; channel++)
+        _duty[channel] = 0;
+    };
+    
+    // Start TCC0 at 'frequency' (Hz), all channels at 0% duty. The prescaler is the smallest one that fits, which
+    // gives the best resolution (getTop() + 1 steps). Pins are connected by attachPin()
+    bool begin(const float& frequency, const SAMDPWMMode& mode = SAMD_PWM_SINGLE_SLOPE);
+    
+    void end();
+    
+    // Connect 'pin' to its TCC0 output. Returns the channel driving it, or -1 if the pin has no TCC0 output
+    int8_t attachPin(const uint8_t& pin);
+    
+    // Duty in percent. The new value is written to the buffer register and takes effect at the next period boundary,
+    // so the running period never gets a glitch. Wrap several channels in lockUpdate() / unlockUpdate() to switch them
+    // in the same period
+    bool setDuty(const uint8_t& channel, const float& duty);
+    
+    // Duty in counter ticks, from 0 to getTop() (+ 1 in single-slope mode). Returns false beyond
+    bool setDutyTicks(const uint8_t& channel, const uint32_t& ticks);
+    
+    // Change the frequency at the next period boundary, keeping the prescaler and the duty of all channels.
+    // The new PER and all the new CCs take effect in the same period
+    bool setFrequency(const float& frequency);
+    
+    // Hold the buffered PER / CC values until unlockUpdate(), so that several setDuty() / setFrequency() calls take
+    // effect together at one period boundary, never split across two. Calls can be nested
+    void lockUpdate();
+    
+    void unlockUpdate();
+    
+    // Dead time (ns) inserted before the low side / high side output of 'channel' (0-3) turns on, at 48MHz
+    // resolution and up to 5.3us. The two times are shared by all dead-time channels; 0, 0 disables it on 'channel'.
+    // Can be called before begin(). Otherwise the outputs stop for a few clock cycles while it's applied
+    bool setDeadTime(const uint8_t& channel, const float& lowSide, const float& highSide);
+    
+    uint32_t getTop()
+    {
+      return _top;
+    }
+    
+    float getFrequency()
+    {
+      if (_top == 0)
+        return 0;
+        
+      float ticks = (_mode == SAMD_PWM_SINGLE_SLOPE) ? _top + 1.0f : 2.0f * _top;
+        
+      return TIMER_HZ / (SAMD_prescalerDivider[_prescalerIndex] * ticks);
+    }
+}; // class SAMDTimerPWM
+
+#endif    // SAMD_TIMER_PWM_HPP
@@ -0,0 +1,23 @@
+/****************************************************************************************************************************
+  SAMD_TimerSeqLock.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Multi-word state shared from an ISR to loop(). The ISR publishes snapshots without waiting, and loop() gets consistent
+  copies without disabling interrupts, so readers add nothing to the interrupt latency.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_SEQLOCK_H
+#define SAMD_TIMER_SEQLOCK_H
+
+// Templates only, nothing to define in the sketch
+#include "SAMD_TimerSeqLock.hpp"
+
+#endif    // SAMD_TIMER_SEQLOCK_H
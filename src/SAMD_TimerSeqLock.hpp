@@ -0,0 +1,149 @@
+/****************************************************************************************************************************
+  SAMD_TimerSeqLock.hpp
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  Multi-word state shared from an ISR to loop(). The ISR publishes snapshots without waiting, and loop() gets consistent
+  copies without disabling interrupts, so readers add nothing to the interrupt latency.
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_SEQLOCK_HPP
+#define SAMD_TIMER_SEQLOCK_HPP
+
+#include "SAMDTimerInterrupt.hpp"
+
+// Both classes take a single writer, e.g. one timer callback, and readers which never preempt it, e.g. loop().
+// A reader retries when a write landed during its copy, so it only waits for as long as the writer keeps interrupting.
+// T must be plain data (no pointers to owned memory, no virtual functions), as it's copied while possibly being written
+
+// Sequence lock. write() copies the whole value, best for small snapshots, e.g. a few timestamps
+template<typename T>
+class SAMDSeqLock
+{
+  private:
+    volatile uint32_t _sequence;      // 2 per write(), odd while a write() is in progress
+    T                 _value;
+    
+  public:
+  
+    SAMDSeqLock() : _sequence(0), _value()
+    {
+    }
+    
+    // Writer side, doesn't wait
+    void write(const T& value)
+    {
+      uint32_t sequence = _sequence;
+      
+      _sequence = sequence + 1;
+      
+      __DMB();
+      _value = value;
+      __DMB();
+      
+      _sequence = sequence + 2;
+    }
+    
+    // Reader side. Consistent copy of the last value written
+    void read(T& value) const
+    {
+      uint32_t sequence;
+      
+      do
+      {
+        sequence = _sequence;
+        
+        __DMB();
+        value = _value;
+        __DMB();
+      } while ( (sequence & 1) || (sequence != _sequence) );
+    }
+    
+    T read() const
+    {
+      T value;
+      
+      read(value);
+      
+      return value;
+    }
+    
+    // Changes on each write(), e.g. to check for a new value before copying it
+    uint32_t getSequence() const
+    {
+      return _sequence;
+    }
+};
+
+////////////////////////////////////////////////////////
+
+// Double buffer. The writer fills back() in place, field by field or over several interrupts, then publish() makes it
+// the front buffer in one store. Best for bigger snapshots, or ones built incrementally
+template<typename T>
+class SAMDDoubleBuffer
+{
+  private:
+    volatile uint32_t _sequence;      // number of publish(), bit 0 selects the front buffer
+    T                 _buffer[2];
+    
+  public:
+  
+    SAMDDoubleBuffer() : _sequence(0), _buffer()
+    {
+    }
+    
+    // Writer side. The buffer not being read. It holds the snapshot published two publish() ago, not the last one
+    T& back()
+    {
+      return _buffer[(_sequence + 1) & 1];
+    }
+    
+    // Writer side, doesn't wait
+    void publish()
+    {
+      // back() complete before it becomes visible
+      __DMB();
+      
+      _sequence = _sequence + 1;
+    }
+    
+    // Reader side. Consistent copy of the last snapshot published. The buffer read only gets written to once it's
+    // back() again, i.e. after the next publish(), so a changed _sequence covers any overlap
+    void read(T& value) const
+    {
+      uint32_t sequence;
+      
+      do
+      {
+        sequence = _sequence;
+        
+        __DMB();
+        value = _buffer[sequence & 1];
+        __DMB();
+      } while (sequence != _sequence);
+    }
+    
+    T read() const
+    {
+      T value;
+      
+      read(value);
+      
+      return value;
+    }
+    
+    // Changes on each publish()
+    uint32_t getSequence() const
+    {
+      return _sequence;
+    }
+};
+
+#endif    // SAMD_TIMER_SEQLOCK_HPP
@@ -0,0 +1,179 @@
+/****************************************************************************************************************************
+  SAMD_TimerTimestamp-Impl.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  64-bit timestamp clock. A 32-bit TC pair counts the timer clock freely, and its overflow interrupt extends the count
+  to 64 bits, for monotonic, rollover-free timestamps read lock-free in a few cycles, unlike SysTick-based micros().
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_TIMESTAMP_IMPL_H
+#define SAMD_TIMER_TIMESTAMP_IMPL_H
+
+SAMDTimestampClock* SAMD_timestamp_instance = NULL;
+
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  void TC0_Handler()
+  {
+    if (SAMD_timestamp_instance)
+      SAMD_timestamp_instance->handleOverflow();
+  }
+  
+#else
+
+  void TC4_Handler()
+  {
+    if (SAMD_timestamp_instance)
+      SAMD_timestamp_instance->handleOverflow();
+  }
+  
+#endif
+
+////////////////////////////////////////////////////////
+
+uint32_t SAMDTimestampClock::readCount()
+{
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  SAMD_TIMESTAMP_TC->COUNT32.CTRLBSET.reg = TC_CTRLBSET_CMD_READSYNC;
+  while (SAMD_TIMESTAMP_TC->COUNT32.SYNCBUSY.bit.CTRLB);
+  while (SAMD_TIMESTAMP_TC->COUNT32.CTRLBSET.bit.CMD);
+  while (SAMD_TIMESTAMP_TC->COUNT32.SYNCBUSY.bit.COUNT);
+#endif
+
+  // SAMD21: continuous read synchronization, set by begin(), so COUNT is always readable at once
+  return SAMD_TIMESTAMP_TC->COUNT32.COUNT.reg;
+}
+
+void SAMDTimestampClock::handleOverflow()
+{
+  SAMD_TIMESTAMP_TC->COUNT32.INTFLAG.reg = TC_INTFLAG_OVF;
+  
+  _overflows++;
+}
+
+uint64_t SAMDTimestampClock::now64()
+{
+  uint32_t high;
+  uint32_t low;
+  bool     pending;
+  
+  do
+  {
+    high    = _overflows;
+    low     = readCount();
+    
+    // Wrapped, but not served yet (read from a higher priority ISR, or with interrupts off). A low count tells it was
+    // read after the wrap, as the overflow interrupt is served long before the counter is half way again
+    pending = (SAMD_TIMESTAMP_TC->COUNT32.INTFLAG.reg & TC_INTFLAG_OVF) && (low < 0x80000000UL);
+    
+    // Retry if the overflow interrupt ran in between
+  } while (high != _overflows);
+  
+  if (pending)
+    high++;
+  
+  return ((uint64_t) high << 32) | low;
+}
+
+bool SAMDTimestampClock::begin(const uint16_t& prescaler)
+{
+  uint8_t prescalerIndex = 0;
+  
+  while ( (prescalerIndex < 8) && (SAMD_prescalerDivider[prescalerIndex] != prescaler) )
+    prescalerIndex++;
+    
+  if (prescalerIndex == 8)
+    return false;
+    
+  end();
+  
+  _tickHz     = TIMER_HZ / prescaler;
+  _overflows  = 0;
+  
+  // Rounded up, so whole ns / us come out exact instead of 1 below
+  uint64_t nsPerTick  = ((1000000000ULL << 32) + _tickHz - 1) / _tickHz;
+  uint64_t usPerTick  = ((1000000ULL << 32) + _tickHz - 1) / _tickHz;
+  
+  _nsPerTick      = nsPerTick >> 32;
+  _nsPerTickFrac  = (uint32_t) nsPerTick;
+  _usPerTick      = usPerTick >> 32;
+  _usPerTickFrac  = (uint32_t) usPerTick;
+  
+  SAMD_timestamp_instance = this;
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  MCLK->APBAMASK.reg |= MCLK_APBAMASK_TC0 | MCLK_APBAMASK_TC1;
+  
+  GCLK->PCHCTRL[TC0_GCLK_ID].reg = GCLK_PCHCTRL_GEN_GCLK1 | GCLK_PCHCTRL_CHEN;
+  while (GCLK->SYNCBUSY.reg > 0);
+  
+  SAMD_TIMESTAMP_TC->COUNT32.CTRLA.reg = TC_CTRLA_SWRST;
+  while (SAMD_TIMESTAMP_TC->COUNT32.SYNCBUSY.bit.SWRST);
+  
+  // Normal frequency mode counts up to 0xFFFFFFFF
+  SAMD_TIMESTAMP_TC->COUNT32.CTRLA.reg    = TC_CTRLA_MODE_COUNT32 | TC_CTRLA_PRESCALER(prescalerIndex);
+  SAMD_TIMESTAMP_TC->COUNT32.INTENSET.reg = TC_INTENSET_OVF;
+  
+  NVIC_EnableIRQ(SAMD_TIMESTAMP_IRQn);
+  
+  SAMD_TIMESTAMP_TC->COUNT32.CTRLA.reg |= TC_CTRLA_ENABLE;
+  while (SAMD_TIMESTAMP_TC->COUNT32.SYNCBUSY.bit.ENABLE);
+  
+#else
+
+  PM->APBCMASK.reg |= PM_APBCMASK_TC4 | PM_APBCMASK_TC5;
+  
+  REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID(GCM_TC4_TC5));
+  while ( GCLK->STATUS.bit.SYNCBUSY == 1 );
+  
+  SAMD_TIMESTAMP_TC->COUNT32.CTRLA.reg = TC_CTRLA_SWRST;
+  while (SAMD_TIMESTAMP_TC->COUNT32.CTRLA.bit.SWRST);
+  
+  // Normal frequency mode counts up to 0xFFFFFFFF
+  SAMD_TIMESTAMP_TC->COUNT32.CTRLA.reg    = TC_CTRLA_MODE_COUNT32 | TC_CTRLA_PRESCALER(prescalerIndex);
+  SAMD_TIMESTAMP_TC->COUNT32.INTENSET.reg = TC_INTENSET_OVF;
+  
+  NVIC_EnableIRQ(SAMD_TIMESTAMP_IRQn);
+  
+  SAMD_TIMESTAMP_TC->COUNT32.CTRLA.reg |= TC_CTRLA_ENABLE;
+  while (SAMD_TIMESTAMP_TC->COUNT32.STATUS.bit.SYNCBUSY);
+  
+  // Keep COUNT synchronized, so readCount() needs no read request and wait
+  SAMD_TIMESTAMP_TC->COUNT32.READREQ.reg = TC_READREQ_RCONT | TC_READREQ_ADDR(0x10);
+  while (SAMD_TIMESTAMP_TC->COUNT32.STATUS.bit.SYNCBUSY);
+  
+#endif
+
+  TISR_LOGDEBUG3(F("SAMDTimestampClock: prescaler ="), prescaler, F(", tickHz ="), _tickHz);
+  
+  return true;
+}
+
+void SAMDTimestampClock::end()
+{
+  if (SAMD_timestamp_instance == NULL)
+    return;
+    
+  NVIC_DisableIRQ(SAMD_TIMESTAMP_IRQn);
+  
+#if (TIMER_INTERRUPT_USING_SAMD51)
+  SAMD_TIMESTAMP_TC->COUNT32.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+  while (SAMD_TIMESTAMP_TC->COUNT32.SYNCBUSY.bit.ENABLE);
+#else
+  SAMD_TIMESTAMP_TC->COUNT32.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+  while (SAMD_TIMESTAMP_TC->COUNT32.STATUS.bit.SYNCBUSY);
+#endif
+
+  SAMD_timestamp_instance = NULL;
+}
+
+#endif    // SAMD_TIMER_TIMESTAMP_IMPL_H
@@ -0,0 +1,23 @@
+/****************************************************************************************************************************
+  SAMD_TimerTimestamp.h
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  64-bit timestamp clock. A 32-bit TC pair counts the timer clock freely, and its overflow interrupt extends the count
+  to 64 bits, for monotonic, rollover-free timestamps read lock-free in a few cycles, unlike SysTick-based micros().
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_TIMESTAMP_H
+#define SAMD_TIMER_TIMESTAMP_H
+
+#include "SAMD_TimerTimestamp.hpp"
+#include "SAMD_TimerTimestamp-Impl.h"
+
+#endif    // SAMD_TIMER_TIMESTAMP_H
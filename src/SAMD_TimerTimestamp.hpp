@@ -0,0 +1,111 @@
+/****************************************************************************************************************************
+  SAMD_TimerTimestamp.hpp
+  For SAMD boards
+  Written by Khoi Hoang
+
+  Built by Khoi Hoang https://github.com/khoih-prog/SAMD_TimerInterrupt
+  Licensed under MIT license
+
+  64-bit timestamp clock. A 32-bit TC pair counts the timer clock freely, and its overflow interrupt extends the count
+  to 64 bits, for monotonic, rollover-free timestamps read lock-free in a few cycles, unlike SysTick-based micros().
+
+  Version: 1.7.0
+*****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef SAMD_TIMER_TIMESTAMP_HPP
+#define SAMD_TIMER_TIMESTAMP_HPP
+
+#include "SAMDTimerInterrupt.hpp"
+
+#if (TIMER_INTERRUPT_USING_SAMD51)
+
+  // TC0 is the master of the 32-bit TC0/TC1 pair, so neither can be used for anything else
+  #define SAMD_TIMESTAMP_TC           TC0
+  #define SAMD_TIMESTAMP_IRQn         TC0_IRQn
+  
+#else
+
+  // TC4 is the master of the 32-bit TC4/TC5 pair, so neither can be used for anything else, such as
+  // SAMDTimerFreqCounter, Servo or tone()
+  #if !defined(TC4) || !defined(TC5)
+    #error SAMDTimestampClock needs TC4 and TC5
+  #endif
+
+  #define SAMD_TIMESTAMP_TC           TC4
+  #define SAMD_TIMESTAMP_IRQn         TC4_IRQn
+  
+#endif
+
+class SAMDTimestampClock;
+
+typedef SAMDTimestampClock SAMD_TimestampClock;
+
+class SAMDTimestampClock
+{
+  private:
+    uint32_t            _tickHz;
+    
+    // Upper 32 bits of the count, incremented by the overflow interrupt
+    volatile uint32_t   _overflows;
+    
+    // ns and us per tick, as 32.32 fixed point: integer part, then fraction
+    uint32_t            _nsPerTick;
+    uint32_t            _nsPerTickFrac;
+    uint32_t            _usPerTick;
+    uint32_t            _usPerTickFrac;
+    
+    uint32_t readCount();
+    
+    // ticks * (perTick + perTickFrac / 2^32), with 32 x 32-bit products only, no 64-bit division
+    static uint64_t scale(const uint64_t& ticks, const uint32_t& perTick, const uint32_t& perTickFrac)
+    {
+      uint32_t hi = ticks >> 32;
+      uint32_t lo = (uint32_t) ticks;
+      
+      return ( ((uint64_t) hi * perTick) << 32 ) + (uint64_t) hi * perTickFrac + (uint64_t) lo * perTick
+             + ( ((uint64_t) lo * perTickFrac) >> 32 );
+    }
+
+  public:
+  
+    SAMDTimestampClock() : _tickHz(0), _overflows(0), _nsPerTick(0), _nsPerTickFrac(0), _usPerTick(0), _usPerTickFrac(0)
+    {
+    };
+    
+    // Count TIMER_HZ / 'prescaler' ticks from 0, 'prescaler' = 1, 2, 4, 8, 16, 64, 256 or 1024. At 48MHz the 32-bit
+    // counter wraps every 89s, so the overflow interrupt is the only CPU load
+    bool begin(const uint16_t& prescaler = 1);
+    
+    void end();
+    
+    // Ticks since begin(). Lock-free, so also right in any ISR and with interrupts off
+    uint64_t now64();
+    
+    uint64_t nowNs()
+    {
+      return scale(now64(), _nsPerTick, _nsPerTickFrac);
+    }
+    
+    uint64_t nowUs()
+    {
+      return scale(now64(), _usPerTick, _usPerTickFrac);
+    }
+    
+    // For differences of now64() values
+    uint64_t ticksToNs(const uint64_t& ticks)
+    {
+      return scale(ticks, _nsPerTick, _nsPerTickFrac);
+    }
+    
+    uint32_t getTickFrequency()
+    {
+      return _tickHz;
+    }
+    
+    // Called by the TC overflow interrupt
+    void handleOverflow();
+}; // class SAMDTimestampClock
+
+#endif    // SAMD_TIMER_TIMESTAMP_HPP
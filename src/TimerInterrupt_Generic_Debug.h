@@ -49,28 +49,131 @@
   #define _TIMERINTERRUPT_LOGLEVEL_       1
 #endif
 
-#define TISR_LOGERROR(x)         if(_TIMERINTERRUPT_LOGLEVEL_>0) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.println(x); }
-#define TISR_LOGERROR0(x)        if(_TIMERINTERRUPT_LOGLEVEL_>0) { TISR_DBG_PORT.print(x); }
-#define TISR_LOGERROR1(x,y)      if(_TIMERINTERRUPT_LOGLEVEL_>0) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(y); }
-#define TISR_LOGERROR2(x,y,z)    if(_TIMERINTERRUPT_LOGLEVEL_>0) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(y); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(z); }
-#define TISR_LOGERROR3(x,y,z,w)  if(_TIMERINTERRUPT_LOGLEVEL_>0) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(y); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(z); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(w); }
-
-#define TISR_LOGWARN(x)          if(_TIMERINTERRUPT_LOGLEVEL_>1) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.println(x); }
-#define TISR_LOGWARN0(x)         if(_TIMERINTERRUPT_LOGLEVEL_>1) { TISR_DBG_PORT.print(x); }
-#define TISR_LOGWARN1(x,y)       if(_TIMERINTERRUPT_LOGLEVEL_>1) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(y); }
-#define TISR_LOGWARN2(x,y,z)     if(_TIMERINTERRUPT_LOGLEVEL_>1) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(y); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(z); }
-#define TISR_LOGWARN3(x,y,z,w)   if(_TIMERINTERRUPT_LOGLEVEL_>1) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(y); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(z); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(w); }
-
-#define TISR_LOGINFO(x)          if(_TIMERINTERRUPT_LOGLEVEL_>2) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.println(x); }
-#define TISR_LOGINFO0(x)         if(_TIMERINTERRUPT_LOGLEVEL_>2) { TISR_DBG_PORT.print(x); }
-#define TISR_LOGINFO1(x,y)       if(_TIMERINTERRUPT_LOGLEVEL_>2) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(y); }
-#define TISR_LOGINFO2(x,y,z)     if(_TIMERINTERRUPT_LOGLEVEL_>2) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(y); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(z); }
-#define TISR_LOGINFO3(x,y,z,w)   if(_TIMERINTERRUPT_LOGLEVEL_>2) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(y); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(z); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(w); }
-
-#define TISR_LOGDEBUG(x)         if(_TIMERINTERRUPT_LOGLEVEL_>3) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.println(x); }
-#define TISR_LOGDEBUG0(x)        if(_TIMERINTERRUPT_LOGLEVEL_>3) { TISR_DBG_PORT.print(x); }
-#define TISR_LOGDEBUG1(x,y)      if(_TIMERINTERRUPT_LOGLEVEL_>3) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(y); }
-#define TISR_LOGDEBUG2(x,y,z)    if(_TIMERINTERRUPT_LOGLEVEL_>3) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(y); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(z); }
-#define TISR_LOGDEBUG3(x,y,z,w)  if(_TIMERINTERRUPT_LOGLEVEL_>3) { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(y); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(z); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(w); }
+// Define TIMERINTERRUPT_DEFERRED_LOG true before including "SAMDTimerInterrupt.h" to make the TISR_LOG* macros only store
+// a compact record (F() string pointers and raw 32-bit values, no text) in a RAM ring, without blocking or allocating,
+// so logging can stay on in ISR context. Call SAMD_flushLog() from loop() to print the stored records.
+// Only string literals or F() strings can be logged then, as the record keeps their address
+#if !defined(TIMERINTERRUPT_DEFERRED_LOG)
+  #define TIMERINTERRUPT_DEFERRED_LOG     false
+#endif
+
+// Records kept before the oldest unprinted one blocks new ones, power of 2
+#ifndef SAMD_LOG_BUFFER_SIZE
+  #define SAMD_LOG_BUFFER_SIZE            32
+#endif
+
+#define SAMD_LOG_MAX_ARGS                 4
+
+typedef enum
+{
+  SAMD_LOG_NONE     = 0,
+  SAMD_LOG_FSTRING  = 1,
+  SAMD_LOG_STRING   = 2,
+  SAMD_LOG_CHAR     = 3,
+  SAMD_LOG_INT      = 4,
+  SAMD_LOG_UINT     = 5,
+  SAMD_LOG_FLOAT    = 6,
+  SAMD_LOG_HEX      = 7,
+} SAMDLogType;
+
+typedef struct
+{
+  uint32_t      value;
+  uint8_t       type;       // SAMDLogType
+} SAMDLogArg;
+
+// Value printed in hex, e.g. a register address. Replaces String(x, HEX), which allocates
+class SAMDLogHex : public Printable
+{
+  public:
+    uint32_t value;
+    
+    SAMDLogHex(const uint32_t& x) : value(x) {}
+    
+    size_t printTo(Print& p) const
+    {
+      return p.print(value, HEX);
+    }
+};
+
+#define TISR_HEX(x)       SAMDLogHex((uint32_t) (x))
+
+// By value, so volatile variables and registers can be logged too
+inline SAMDLogArg SAMD_logArg(const __FlashStringHelper* x)  { SAMDLogArg a = { (uint32_t) x, SAMD_LOG_FSTRING }; return a; }
+inline SAMDLogArg SAMD_logArg(const char* x)                 { SAMDLogArg a = { (uint32_t) x, SAMD_LOG_STRING };  return a; }
+inline SAMDLogArg SAMD_logArg(char x)                        { SAMDLogArg a = { (uint32_t) x, SAMD_LOG_CHAR };    return a; }
+inline SAMDLogArg SAMD_logArg(int x)                         { SAMDLogArg a = { (uint32_t) x, SAMD_LOG_INT };     return a; }
+inline SAMDLogArg SAMD_logArg(long x)                        { SAMDLogArg a = { (uint32_t) x, SAMD_LOG_INT };     return a; }
+inline SAMDLogArg SAMD_logArg(unsigned int x)                { SAMDLogArg a = { (uint32_t) x, SAMD_LOG_UINT };    return a; }
+inline SAMDLogArg SAMD_logArg(unsigned long x)               { SAMDLogArg a = { (uint32_t) x, SAMD_LOG_UINT };    return a; }
+inline SAMDLogArg SAMD_logArg(const SAMDLogHex& x)           { SAMDLogArg a = { x.value, SAMD_LOG_HEX };          return a; }
+
+inline SAMDLogArg SAMD_logArg(float x)
+{
+  SAMDLogArg a = { 0, SAMD_LOG_FLOAT };
+  
+  memcpy(&a.value, &x, sizeof(float));
+  
+  return a;
+}
+
+inline SAMDLogArg SAMD_logArg(double x)
+{
+  return SAMD_logArg((float) x);
+}
+
+// Store one record, 'line' => "[TISR] " prefix, args separated by spaces and a newline, as printed by TISR_LOG*.
+// Returns false, and counts the record as dropped, when the ring is full
+bool SAMD_logWrite(const bool& line, const SAMDLogArg& a, const SAMDLogArg& b = SAMDLogArg(),
+                   const SAMDLogArg& c = SAMDLogArg(), const SAMDLogArg& d = SAMDLogArg());
+
+// Print the stored records to TISR_DBG_PORT and free them. Returns the number printed, always 0 when
+// TIMERINTERRUPT_DEFERRED_LOG is false. Call from loop() only, not from an ISR
+uint16_t SAMD_flushLog();
+
+// Records lost because the ring was full
+uint32_t SAMD_getLogDropped();
+
+#if (TIMERINTERRUPT_DEFERRED_LOG)
+
+  #define TISR_LOG_RAW(x)               SAMD_logWrite(false, SAMD_logArg(x))
+  #define TISR_LOG_LINE1(x)             SAMD_logWrite(true, SAMD_logArg(x))
+  #define TISR_LOG_LINE2(x,y)           SAMD_logWrite(true, SAMD_logArg(x), SAMD_logArg(y))
+  #define TISR_LOG_LINE3(x,y,z)         SAMD_logWrite(true, SAMD_logArg(x), SAMD_logArg(y), SAMD_logArg(z))
+  #define TISR_LOG_LINE4(x,y,z,w)       SAMD_logWrite(true, SAMD_logArg(x), SAMD_logArg(y), SAMD_logArg(z), SAMD_logArg(w))
+  
+#else
+
+  #define TISR_LOG_RAW(x)               { TISR_DBG_PORT.print(x); }
+  #define TISR_LOG_LINE1(x)             { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.println(x); }
+  #define TISR_LOG_LINE2(x,y)           { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(y); }
+  #define TISR_LOG_LINE3(x,y,z)         { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(y); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(z); }
+  #define TISR_LOG_LINE4(x,y,z,w)       { TISR_DBG_PORT.print("[TISR] "); TISR_DBG_PORT.print(x); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(y); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.print(z); TISR_DBG_PORT.print(" "); TISR_DBG_PORT.println(w); }
+  
+#endif
+
+#define TISR_LOGERROR(x)         if(_TIMERINTERRUPT_LOGLEVEL_>0) { TISR_LOG_LINE1(x); }
+#define TISR_LOGERROR0(x)        if(_TIMERINTERRUPT_LOGLEVEL_>0) { TISR_LOG_RAW(x); }
+#define TISR_LOGERROR1(x,y)      if(_TIMERINTERRUPT_LOGLEVEL_>0) { TISR_LOG_LINE2(x,y); }
+#define TISR_LOGERROR2(x,y,z)    if(_TIMERINTERRUPT_LOGLEVEL_>0) { TISR_LOG_LINE3(x,y,z); }
+#define TISR_LOGERROR3(x,y,z,w)  if(_TIMERINTERRUPT_LOGLEVEL_>0) { TISR_LOG_LINE4(x,y,z,w); }
+
+#define TISR_LOGWARN(x)          if(_TIMERINTERRUPT_LOGLEVEL_>1) { TISR_LOG_LINE1(x); }
+#define TISR_LOGWARN0(x)         if(_TIMERINTERRUPT_LOGLEVEL_>1) { TISR_LOG_RAW(x); }
+#define TISR_LOGWARN1(x,y)       if(_TIMERINTERRUPT_LOGLEVEL_>1) { TISR_LOG_LINE2(x,y); }
+#define TISR_LOGWARN2(x,y,z)     if(_TIMERINTERRUPT_LOGLEVEL_>1) { TISR_LOG_LINE3(x,y,z); }
+#define TISR_LOGWARN3(x,y,z,w)   if(_TIMERINTERRUPT_LOGLEVEL_>1) { TISR_LOG_LINE4(x,y,z,w); }
+
+#define TISR_LOGINFO(x)          if(_TIMERINTERRUPT_LOGLEVEL_>2) { TISR_LOG_LINE1(x); }
+#define TISR_LOGINFO0(x)         if(_TIMERINTERRUPT_LOGLEVEL_>2) { TISR_LOG_RAW(x); }
+#define TISR_LOGINFO1(x,y)       if(_TIMERINTERRUPT_LOGLEVEL_>2) { TISR_LOG_LINE2(x,y); }
+#define TISR_LOGINFO2(x,y,z)     if(_TIMERINTERRUPT_LOGLEVEL_>2) { TISR_LOG_LINE3(x,y,z); }
+#define TISR_LOGINFO3(x,y,z,w)   if(_TIMERINTERRUPT_LOGLEVEL_>2) { TISR_LOG_LINE4(x,y,z,w); }
+
+#define TISR_LOGDEBUG(x)         if(_TIMERINTERRUPT_LOGLEVEL_>3) { TISR_LOG_LINE1(x); }
+#define TISR_LOGDEBUG0(x)        if(_TIMERINTERRUPT_LOGLEVEL_>3) { TISR_LOG_RAW(x); }
+#define TISR_LOGDEBUG1(x,y)      if(_TIMERINTERRUPT_LOGLEVEL_>3) { TISR_LOG_LINE2(x,y); }
+#define TISR_LOGDEBUG2(x,y,z)    if(_TIMERINTERRUPT_LOGLEVEL_>3) { TISR_LOG_LINE3(x,y,z); }
+#define TISR_LOGDEBUG3(x,y,z,w)  if(_TIMERINTERRUPT_LOGLEVEL_>3) { TISR_LOG_LINE4(x,y,z,w); }
 
 #endif    //TIMERINTERRUPT_GENERIC_DEBUG_H